@@ -49,6 +49,24 @@ void setInitConfig() {
 	config.particleNum              = 5;
 	config.maxIteration             = 10;
 	config.expansionStrategy        = MVS::EXPANSION_BEST_FIRST;
+	config.fitnessKernel            = FitnessKernel::KERNEL_AUTO;
+	config.edgePrecision            = Camera::EDGE_FLOAT;
+	config.coarseStride             = 1;
+	config.coarseIterationRatio     = 0.7;
+	config.randomSeed               = 0;
+	config.stagnationIteration      = 0;
+	config.minImprovement           = 0;
+	config.maxEvaluation            = 0;
+	config.seedLocalRefinement      = MVS::LOCAL_NONE;
+	config.expansionLocalRefinement = MVS::LOCAL_NONE;
+	config.localIteration           = 20;
+	config.localStepRatio           = 0.05;
+	config.optimizer                = MVS::OPTIMIZER_PSO;
+	config.swarmInitialization      = Optimizer::INIT_UNIFORM;
+	config.warmStartNum             = 0;
+	config.batchPatchNum            = 1;
+	config.expansionWaveNum         = 1;
+	config.expansionSchedulerEnable = false;
 }
 
 void runViewer(MVS &mvs, const char *fileName) {
@@ -3,6 +3,61 @@
 
 #include "fileloader.h"
 
+// MvsConfig layout written by MVS_V3 file (frozen, leading fields of MvsConfig)
+struct MvsConfigV3 {
+	// image cell size (pixel*pixel)
+	int cellSize;
+	// patch radius in pixel
+	int patchRadius;
+	// patch size 2*radius+1
+	int patchSize;
+	// minimum visible camera number
+	int minCamNum;
+	// intensity variation in patch for LOD
+	double textureVariation;
+	// expand visible camera
+	double visibleCorrelation;
+	// minimum patch correlation when filtering patch visible camera
+	double minCorrelation;
+	// fitness threshold
+	double maxFitness;
+	// LOD ratio
+	double lodRatio;
+	// minimum LOD
+	int minLOD;
+	// maximum LOD
+	int maxLOD;
+	// maxium cell patch number
+	int maxCellPatchNum;
+	// reduce PSO search range for expansion patch
+	double reduceNormalRange;
+	// enable adaptive weighting
+	bool adaptiveDistanceEnable;
+	bool adaptiveDifferenceEnable;
+	bool adaptiveGradientEnable;
+	// patch distance weighting
+	double distWeighting;
+	// patch difference weighting
+	double diffWeighting;
+	// patch gradient maginitude weighting
+	double gradientWeighting;
+	// neighbor radius
+	double neighborRadius;
+	// neighbor radius scalar (PCMVS)
+	double neighborRadiusScalar;
+	// minimum region ratio
+	double minRegionRatio;
+	// depth range scalar (pixel)
+	double depthRangeScalar;
+	// PSO parameter
+	// particle number
+	int particleNum;
+	// maximum iteration number
+	int maxIteration;
+	// expansion strategy (best, worst, breath, depth)
+	int expansionStrategy;
+};
+
 FileLoader::FileLoader(void) {}
 FileLoader::~FileLoader(void) {}
 
@@ -164,9 +219,28 @@ Patch FileLoader::loadNvmPatch(ifstream &file, const MVS &mvs) {
 	return Patch(center, color, camIdx, imgPoint);
 }
 
-MvsConfig FileLoader::loadMvsConfig(ifstream &file) {
-	MvsConfig config;
-	file.read((char*) &config, sizeof(MvsConfig));
+MvsConfig FileLoader::loadMvsConfig(ifstream &file, const MVS &mvs, const bool hasSize) {
+	// fields missing in file keep current config
+	MvsConfig config = static_cast<const MvsConfig&> (mvs);
+
+	// MVS_V3 config without size
+	if (!hasSize) {
+		MvsConfigV3 configV3;
+		file.read((char*) &configV3, sizeof(MvsConfigV3));
+		memcpy(&config, &configV3, offsetof(MvsConfig, fitnessKernel));
+		return config;
+	}
+
+	// read config size (MVS_V4)
+	int configSize;
+	file.read((char*) &configSize, sizeof(int));
+
+	const int readSize = min(configSize, (int) sizeof(MvsConfig));
+	file.read((char*) &config, readSize);
+	// skip fields of newer version
+	if (configSize > readSize) {
+		file.seekg(configSize - readSize, ifstream::cur);
+	}
 	return config;
 }
 
@@ -250,7 +324,7 @@ void FileLoader::loadMvsVec(ifstream &file, Vec4d &v) {
 
 void FileLoader::loadNVM(const char *fileName, MVS &mvs) {
 	vector<Camera>  &cameras = mvs.cameras;
-	map<int, Patch> &patches = mvs.patches;
+	SlotMap<Patch> &patches = mvs.patches;
 
 	// reset container
 	cameras.clear();
@@ -312,7 +386,7 @@ void FileLoader::loadNVM(const char *fileName, MVS &mvs) {
 			for (int i = 0; i < num; i++) {
 				printf("\rloading patches: %d / %d", i+1, num);
 				Patch p = loadNvmPatch(file, mvs);
-				patches.insert( pair<int, Patch>(p.getId(), p) );
+				patches.insert(p.getId(), p);
 			}
 			printf("\n");
 			loadPatch = false;
@@ -326,7 +400,7 @@ void FileLoader::loadNVM(const char *fileName, MVS &mvs) {
 
 void FileLoader::loadNVM2(const char *fileName, MVS &mvs) {
 	vector<Camera>  &cameras = mvs.cameras;
-	map<int, Patch> &patches = mvs.patches;
+	SlotMap<Patch> &patches = mvs.patches;
 
 	// reset container
 	cameras.clear();
@@ -388,7 +462,7 @@ void FileLoader::loadNVM2(const char *fileName, MVS &mvs) {
 			for (int i = 0; i < num; i++) {
 				printf("\rloading patches: %d / %d", i+1, num);
 				Patch p = loadNvmPatch(file, mvs);
-				patches.insert( pair<int, Patch>(p.getId(), p) );
+				patches.insert(p.getId(), p);
 			}
 			printf("\n");
 			loadPatch = false;
@@ -402,7 +476,7 @@ void FileLoader::loadNVM2(const char *fileName, MVS &mvs) {
 
 void FileLoader::loadMVS(const char *fileName, MVS &mvs) {
 	vector<Camera>  &cameras = mvs.cameras;
-	map<int, Patch> &patches = mvs.patches;
+	SlotMap<Patch> &patches = mvs.patches;
 
 	// reset container
 	cameras.clear();
@@ -436,7 +510,15 @@ void FileLoader::loadMVS(const char *fileName, MVS &mvs) {
 
 		// set config and start load camera
 		if (strcmp(strip, "MVS_V3") == 0) {
-			MvsConfig config = loadMvsConfig(file);
+			MvsConfig config = loadMvsConfig(file, mvs, false);
+			mvs.setConfig(config);
+			loadCamera = true;
+			continue;
+		}
+
+		// set config (with config size) and start load camera
+		if (strcmp(strip, "MVS_V4") == 0) {
+			MvsConfig config = loadMvsConfig(file, mvs, true);
 			mvs.setConfig(config);
 			loadCamera = true;
 			continue;
@@ -461,7 +543,7 @@ void FileLoader::loadMVS(const char *fileName, MVS &mvs) {
 			for (int i = 0; i < num; ++i) {
 				printf("\rloading patches: %d / %d", i+1, num);
 				Patch pth = loadMvsPatch(file);
-				patches.insert( pair<int, Patch>(pth.getId(), pth) );
+				patches.insert(pth.getId(), pth);
 			}
 			printf("\n");
 			loadPatch = false;
@@ -557,6 +639,60 @@ void FileLoader::loadConfig(const char *fileName, MvsConfig &config) {
 		} else if ( strcmp(strip, "neighborRadiusScalar") == 0 ) {
 			strip = strtok(NULL, " \t");
 			config.neighborRadiusScalar = atof(strip);
+		} else if ( strcmp(strip, "fitnessKernel") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.fitnessKernel = atoi(strip);
+		} else if ( strcmp(strip, "edgePrecision") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.edgePrecision = atoi(strip);
+		} else if ( strcmp(strip, "coarseStride") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.coarseStride = atoi(strip);
+		} else if ( strcmp(strip, "coarseIterationRatio") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.coarseIterationRatio = atof(strip);
+		} else if ( strcmp(strip, "randomSeed") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.randomSeed = atoi(strip);
+		} else if ( strcmp(strip, "stagnationIteration") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.stagnationIteration = atoi(strip);
+		} else if ( strcmp(strip, "minImprovement") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.minImprovement = atof(strip);
+		} else if ( strcmp(strip, "maxEvaluation") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.maxEvaluation = atoi(strip);
+		} else if ( strcmp(strip, "seedLocalRefinement") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.seedLocalRefinement = atoi(strip);
+		} else if ( strcmp(strip, "expansionLocalRefinement") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.expansionLocalRefinement = atoi(strip);
+		} else if ( strcmp(strip, "localIteration") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.localIteration = atoi(strip);
+		} else if ( strcmp(strip, "localStepRatio") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.localStepRatio = atof(strip);
+		} else if ( strcmp(strip, "optimizer") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.optimizer = atoi(strip);
+		} else if ( strcmp(strip, "swarmInitialization") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.swarmInitialization = atoi(strip);
+		} else if ( strcmp(strip, "warmStartNum") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.warmStartNum = atoi(strip);
+		} else if ( strcmp(strip, "batchPatchNum") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.batchPatchNum = atoi(strip);
+		} else if ( strcmp(strip, "expansionWaveNum") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.expansionWaveNum = atoi(strip);
+		} else if ( strcmp(strip, "expansionSchedulerEnable") == 0 ) {
+			strip = strtok(NULL, " \t");
+			config.expansionSchedulerEnable = atoi(strip);
 		}
 	}
 
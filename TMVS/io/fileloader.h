@@ -27,7 +27,7 @@ namespace PAIS {
 		static Camera loadNvmCamera(ifstream &file, const char* path);
 		static Camera loadNvm2Camera(ifstream &file, const char* path);
 		static Patch  loadNvmPatch(ifstream &file, const MVS &mvs);
-		static MvsConfig loadMvsConfig(ifstream &file);
+		static MvsConfig loadMvsConfig(ifstream &file, const MVS &mvs, const bool hasSize);
 		static Camera loadMvsCamera(ifstream &file);
 		static Patch  loadMvsPatch(ifstream &file);
 		static void   loadMvsVec(ifstream &file, Vec2d &v);
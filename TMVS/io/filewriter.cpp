@@ -2,6 +2,9 @@
 
 void FileWriter::writeMvsConfig(fstream &file, const MVS &mvs) {
 	const MvsConfig *config = static_cast<const MvsConfig*> (&mvs);
+	const int configSize = (int) sizeof(MvsConfig);
+	// write config size (MVS_V4)
+	file.write((char*) &configSize, sizeof(int));
 	file.write((char*) config, sizeof(MvsConfig));
 }
 
@@ -76,7 +79,7 @@ void FileWriter::writeMVS(const char *fileName, const MVS &mvs) {
 	}
 
 	// write MVS header
-	file << "MVS_V3" << endl;
+	file << "MVS_V4" << endl;
 
 	// write MVS config
 	writeMvsConfig(file, mvs);
@@ -90,20 +93,19 @@ void FileWriter::writeMVS(const char *fileName, const MVS &mvs) {
 	}
 
 	// write patches
-	const map<int, Patch> &patches = mvs.getPatches();
+	const SlotMap<Patch> &patches = mvs.getPatches();
 	const int patchNum = (int) patches.size();
 	file << "PATCHES " << patchNum << endl;
-	map<int, Patch>::const_iterator it;
-	for (it = patches.begin(); it != patches.end(); ++it) {
-		writePatch(file, (*it).second);
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		writePatch(file, patches.at(s));
 	}
 
 	file.close();
 }
 
 void FileWriter::writePLY(const char *fileName, const MVS &mvs) {
-	const map<int, Patch> &patches = mvs.getPatches();
-	map<int, Patch>::const_iterator it;
+	const SlotMap<Patch> &patches = mvs.getPatches();
 	ofstream file;
 	file.open(fileName, ofstream::out);
 	if ( !file.is_open() ) {
@@ -125,8 +127,9 @@ void FileWriter::writePLY(const char *fileName, const MVS &mvs) {
 	file << "property uchar diffuse_blue"  << endl;
 	file << "end_header"                   << endl;
 
-	for (it = patches.begin(); it != patches.end(); ++it) {
-		const Patch &pth = it->second;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		const Patch &pth = patches.at(s);
 		const Vec3d &p   = pth.getCenter();
 		const Vec3d &n   = pth.getNormal();
 		const Vec3b &c   = pth.getColor();
@@ -139,8 +142,7 @@ void FileWriter::writePLY(const char *fileName, const MVS &mvs) {
 }
 
 void FileWriter::wirtePSR(const char *fileName, const MVS &mvs) {
-	const map<int, Patch> &patches = mvs.getPatches();
-	map<int, Patch>::const_iterator it;
+	const SlotMap<Patch> &patches = mvs.getPatches();
 	ofstream file;
 	file.open(fileName, ofstream::binary);
 	if ( !file.is_open() ) {
@@ -148,8 +150,9 @@ void FileWriter::wirtePSR(const char *fileName, const MVS &mvs) {
 		return;
 	}
 
-	for (it = patches.begin(); it != patches.end(); ++it) {
-		const Patch &pth = it->second;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		const Patch &pth = patches.at(s);
 		const Vec3d &p   = pth.getCenter();
 		const Vec3d &n   = pth.getNormal();
 		float num;
@@ -178,7 +181,7 @@ void FileWriter::writeDeletedPatchMVS(const char *fileName, const MVS &mvs) {
 	}
 
 	// write MVS header
-	file << "MVS_V3" << endl;
+	file << "MVS_V4" << endl;
 
 	// write MVS config
 	writeMvsConfig(file, mvs);
@@ -23,6 +23,7 @@ void LogManager::log(const char *message, ...) {
 	vsnprintf (buffer, STRING_BUFFER_LENGTH-1, message, argptr);
 	va_end(argptr);
 
+	#pragma omp critical (log)
 	(*instance) << "[Log]     " << buffer << endl;
 }
 
@@ -36,6 +37,7 @@ void LogManager::warning(const char *message, ...) {
 	vsnprintf (buffer, STRING_BUFFER_LENGTH-1, message, argptr);
 	va_end(argptr);
 
+	#pragma omp critical (log)
 	(*instance) << "[Warning] " << buffer << endl;
 }
 
@@ -49,6 +51,7 @@ void LogManager::error(const char *message, ...) {
 	vsnprintf (buffer, STRING_BUFFER_LENGTH-1, message, argptr);
 	va_end(argptr);
 
+	#pragma omp critical (log)
 	(*instance) << "[Error]   " << buffer << endl;
 }
 
@@ -5,7 +5,9 @@ using namespace PAIS;
 int AbstractPatch::globalId = 0;
 
 AbstractPatch::AbstractPatch(const int id) {
-	if (id < 0) {
+	if (id == ID_NONE) {
+		this->id = -1;
+	} else if (id < 0) {
 		#pragma omp critical
 		{
 			this->id = globalId++;
@@ -17,6 +19,16 @@ AbstractPatch::AbstractPatch(const int id) {
 	init();
 }
 
+int AbstractPatch::reserveId(const int num) {
+	int id;
+	#pragma omp critical
+	{
+		id = globalId;
+		globalId += num;
+	}
+	return id;
+}
+
 AbstractPatch::~AbstractPatch(void) {
 
 }
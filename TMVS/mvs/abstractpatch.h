@@ -72,9 +72,16 @@ namespace PAIS {
 		virtual void removeInvisibleCamera()   = 0;
 
 	public:
+		// id of empty patch, no id is taken from global counter
+		static const int ID_NONE = -2;
+
+		// new global id if id is -1
 		AbstractPatch(const int id = -1);
 		~AbstractPatch(void);
 
+		// reserve num consecutive patch ids for patches created concurrently, return first id
+		static int reserveId(const int num);
+
 		// getters
 		int getId()                        const    { return id;                  }
 		const Vec3d& getCenter()           const    { return center;              }
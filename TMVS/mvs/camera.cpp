@@ -33,9 +33,25 @@ Mat_<double> Camera::quaternionToRotationMat(const Vec4d &q) {
     return R;
 }
 
+void Camera::setEdgePrecision(const Mat_<double> &edge, const int precision, Mat &out) {
+	switch (precision) {
+	default:
+	case EDGE_DOUBLE:
+		out = edge;
+		break;
+	case EDGE_FLOAT:
+		edge.convertTo(out, CV_32F);
+		break;
+	case EDGE_UINT8:
+		edge.convertTo(out, CV_8U, 255.0);
+		break;
+	}
+}
+
 // object function
 Camera::Camera(void) {
 	_isAvaliable = false;
+	gradientWeighting = 0;
 }
 
 Camera::~Camera(void) {
@@ -44,6 +60,7 @@ Camera::~Camera(void) {
 
 Camera::Camera(const char *fileName, const Vec2d &focal, const Vec2d &principlePoint, const Vec4d &quaternion, const Vec3d &center, const double radialDistortion) {
 	_isAvaliable = false;
+	gradientWeighting = 0;
 
 	const MVS &mvs = MVS::getInstance();
 
@@ -66,29 +83,32 @@ Camera::Camera(const char *fileName, const Vec2d &focal, const Vec2d &principleP
 	// read gray level image pyramid
 	imgPyramid.resize(maxLOD+1);
 	edgePyramid.resize(maxLOD+1);
+	gradientWeightPyramid.resize(maxLOD+1);
 	imgPyramid[0] = imread(fileName, 0);
 
-	Mat_<double> gradientX, gradientY;
+	Mat_<double> gradientX, gradientY, edge;
 	Sobel(imgPyramid[0], gradientX, CV_64F, 1, 0, 1);
 	Sobel(imgPyramid[0], gradientY, CV_64F, 0, 1, 1);
-	sqrt(gradientX.mul(gradientX) + gradientY.mul(gradientY), edgePyramid[0]);
+	sqrt(gradientX.mul(gradientX) + gradientY.mul(gradientY), edge);
 	double minG, maxG;
-	minMaxLoc(edgePyramid[0], &minG, &maxG);
-	edgePyramid[0] = (edgePyramid[0] - minG) / (maxG - minG);
+	minMaxLoc(edge, &minG, &maxG);
+	edge = (edge - minG) / (maxG - minG);
+	setEdgePrecision(edge, mvs.edgePrecision, edgePyramid[0]);
 
 	#pragma omp parallel for
 	for (int i = 1; i <= maxLOD; i++) {
 		double size = pow(mvs.lodRatio, i);
-		Mat_<double> gradientX, gradientY;
+		Mat_<double> gradientX, gradientY, edge;
 		double minG, maxG;
 
 		resize(imgPyramid[0], imgPyramid[i], Size(), size, size, INTER_AREA);
 
 		Sobel(imgPyramid[i], gradientX, CV_64F, 1, 0, 1);
 		Sobel(imgPyramid[i], gradientY, CV_64F, 0, 1, 1);
-		sqrt(gradientX.mul(gradientX) + gradientY.mul(gradientY), edgePyramid[i]);
-		minMaxLoc(edgePyramid[i], &minG, &maxG);
-		edgePyramid[i] = (edgePyramid[i] - minG) / (maxG - minG);
+		sqrt(gradientX.mul(gradientX) + gradientY.mul(gradientY), edge);
+		minMaxLoc(edge, &minG, &maxG);
+		edge = (edge - minG) / (maxG - minG);
+		setEdgePrecision(edge, mvs.edgePrecision, edgePyramid[i]);
 	}
 
 	// set focal length
@@ -120,11 +140,17 @@ Camera::Camera(const char *fileName, const Vec2d &focal, const Vec2d &principleP
 	this->translation = -rotation * Mat(center);
 
 	// set projection matrix
-	this->KR = intrinsic * rotation;
-	this->KT = intrinsic * translation;
+	const Mat_<double> KRM = intrinsic * rotation;
+	const Mat_<double> KTM = intrinsic * translation;
 	this->P  = Mat_<double>(3, 4);
-	KR.copyTo(P(Rect(0,0,3,3)));
-    KT.copyTo(P(Rect(3,0,1,3)));
+	for (int r = 0; r < 3; ++r) {
+		for (int c = 0; c < 3; ++c) {
+			KR(r, c) = KRM.at<double>(r, c);
+			P.at<double>(r, c) = KR(r, c);
+		}
+		KT[r] = KTM.at<double>(r, 0);
+		P.at<double>(r, 3) = KT[r];
+	}
 
 	// set camera optical normal
 	double dir_data [] = {0.0, 0.0, 1.0};
@@ -135,20 +161,91 @@ Camera::Camera(const char *fileName, const Vec2d &focal, const Vec2d &principleP
 	_isAvaliable = true;
 }
 
+const Mat_<float>& Camera::getPyramidGradientWeight(const int LOD) const {
+	const MVS &mvs = MVS::getInstance();
+
+	#pragma omp critical (cameraGradientWeight)
+	{
+		// rebuild all levels if gradient weighting is changed
+		if (gradientWeighting != mvs.gradientWeighting) {
+			for (int i = 0; i < (int) gradientWeightPyramid.size(); ++i) {
+				gradientWeightPyramid[i].release();
+			}
+			gradientWeighting = mvs.gradientWeighting;
+		}
+
+		Mat_<float> &weight = gradientWeightPyramid[LOD];
+		if (weight.empty()) {
+			Mat_<double> edge;
+			getPyramidEdge(LOD, edge);
+			weight = Mat_<float>(edge.rows, edge.cols);
+			for (int y = 0; y < edge.rows; ++y) {
+				for (int x = 0; x < edge.cols; ++x) {
+					weight(y, x) = (float) exp( -1.0 / (edge(y, x)*gradientWeighting) );
+				}
+			}
+		}
+	}
+
+	return gradientWeightPyramid[LOD];
+}
+
+void Camera::getPyramidEdge(const int LOD, Mat_<double> &edge) const {
+	const Mat &stored = edgePyramid[LOD];
+	switch (stored.depth()) {
+	default:
+	case CV_64F:
+		edge = stored;
+		break;
+	case CV_32F:
+		stored.convertTo(edge, CV_64F);
+		break;
+	case CV_8U:
+		stored.convertTo(edge, CV_64F, 1.0/255.0);
+		break;
+	}
+}
+
+size_t Camera::getMemoryUsage(size_t *edge) const {
+	size_t image = 0;
+	size_t edgeSize = 0;
+
+	image += imgRGB.total() * imgRGB.elemSize();
+	image += imgMask.total() * imgMask.elemSize();
+	for (int i = 0; i < (int) imgPyramid.size(); ++i) {
+		image += imgPyramid[i].total() * imgPyramid[i].elemSize();
+	}
+	for (int i = 0; i < (int) edgePyramid.size(); ++i) {
+		edgeSize += edgePyramid[i].total() * edgePyramid[i].elemSize();
+	}
+	for (int i = 0; i < (int) gradientWeightPyramid.size(); ++i) {
+		edgeSize += gradientWeightPyramid[i].total() * gradientWeightPyramid[i].elemSize();
+	}
+
+	if (edge != NULL) *edge = edgeSize;
+	return image + edgeSize;
+}
+
 bool Camera::project(const Vec3d &in3D, Vec2d &out2D, const int LOD, const bool applyDistortion) const {
 	const MVS &mvs = MVS::getInstance();
 
-	Mat X2 = rotation * Mat(in3D, false) + translation;
+	// camera coordinate X2 = R*X + T
+	Vec3d X2;
+	for (int r = 0; r < 3; ++r) {
+		X2[r] = rotation.at<double>(r, 0) * in3D[0] + 
+		        rotation.at<double>(r, 1) * in3D[1] + 
+		        rotation.at<double>(r, 2) * in3D[2] + translation.at<double>(r, 0);
+	}
 	
 	if ( !applyDistortion ) {
         // without radial distortion
-		out2D[0] = focal[0] * ( X2.at<double>(0,0) / X2.at<double>(2,0) );
-		out2D[1] = focal[1] * ( X2.at<double>(1,0) / X2.at<double>(2,0) );
+		out2D[0] = focal[0] * ( X2[0] / X2[2] );
+		out2D[1] = focal[1] * ( X2[1] / X2[2] );
         out2D   += principlePoint;
     } else {
         // with radial distortion
-		out2D[0] = X2.at<double>(0,0) / X2.at<double>(2,0);
-		out2D[1] = X2.at<double>(1,0) / X2.at<double>(2,0);
+		out2D[0] = X2[0] / X2[2];
+		out2D[1] = X2[1] / X2[2];
         double r = radialDistortion * (out2D[0]*out2D[0] + out2D[1]*out2D[1]);
         out2D[0]  = (1.0+r) * focal[0] * out2D[0] + principlePoint[0];
 		out2D[1]  = (1.0+r) * focal[1] * out2D[1] + principlePoint[1];
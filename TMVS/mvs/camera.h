@@ -31,7 +31,12 @@ namespace PAIS {
 
 		// gray level image pyramid from 0 = original size to vector size = 1 pixel size
 		vector<Mat_<uchar> > imgPyramid;
-		vector<Mat_<double> > edgePyramid;
+		// normalized edge pyramid stored in configured precision (double, float or uint8)
+		vector<Mat> edgePyramid;
+		// gradient weighting pyramid exp(-1/(edge*gradientWeighting)), built on demand
+		mutable vector<Mat_<float> > gradientWeightPyramid;
+		// gradient weighting of built pyramid levels
+		mutable double gradientWeighting;
 		// rgb level image pyramid
 		// vector<Mat_<Vec3b> > rgbPyramid;
 
@@ -57,8 +62,8 @@ namespace PAIS {
 		Mat_<double> translation;
 
 		// projection matrix
-		Mat_<double> KR;
-		Mat_<double> KT;
+		Matx33d KR;
+		Vec3d   KT;
 		Mat_<double> P;
 
 		// camera center in world coordinate
@@ -69,7 +74,14 @@ namespace PAIS {
 
 		// convert quaternion to rotation matrix 
 		static Mat_<double> Camera::quaternionToRotationMat(const Vec4d &q);
+		// store normalized edge image in precision
+		static void setEdgePrecision(const Mat_<double> &edge, const int precision, Mat &out);
 	public:
+		// edge pyramid storage precision
+		static const int EDGE_DOUBLE = 0x00;
+		static const int EDGE_FLOAT  = 0x01;
+		static const int EDGE_UINT8  = 0x02;
+
 		Camera(void);
 		// for load nvm format
 		Camera(const char *fileName, const Vec2d &focal, const Vec2d &principlePoint, const Vec4d &quaternion, const Vec3d &center, const double radialDistortion);
@@ -81,8 +93,10 @@ namespace PAIS {
 		const Mat_<bool>& getMaskImage()                   const { return imgMask;          }
 		const vector<Mat_<uchar> >& getPyramidImage()      const { return imgPyramid;       }
 		const Mat_<uchar>& getPyramidImage(const int LOD)  const { return imgPyramid[LOD];  }
-		const vector<Mat_<double> >& getPyramidEdge()      const { return edgePyramid;      }
-		const Mat_<double>& getPyramidEdge(const int LOD)  const { return edgePyramid[LOD]; }
+		// get normalized edge image of LOD in double (shared data if stored in double)
+		void getPyramidEdge(const int LOD, Mat_<double> &edge) const;
+		// get gradient weighting image of LOD (built on first use)
+		const Mat_<float>& getPyramidGradientWeight(const int LOD) const;
 		const int getMaxLOD()                              const { return maxLOD;           }
 
 		// get intrinsic information
@@ -101,12 +115,14 @@ namespace PAIS {
 		const Vec3d& getOpticalNormal()                 const { return opticalNormal;    }
 
 		// get projection matrix
-		const Mat_<double>& getKR()                      const { return KR;               }
-		const Mat_<double>& getKT()                      const { return KT;               }
+		const Matx33d& getKR()                           const { return KR;               }
+		const Vec3d& getKT()                             const { return KT;               }
 		const Mat_<double>& getP()                       const { return P;                }
 
 		// check camera status is avaliable
 		bool isAvaliable()                              const { return _isAvaliable;     }
+		// get memory usage of images in bytes (edge: edge and gradient weighting pyramid part)
+		size_t getMemoryUsage(size_t *edge = NULL) const;
 
 		// project a 3D point to image using a specified level of detail image (0 for original size)
 		// and return is in image or not
@@ -0,0 +1,270 @@
+#include "fitnesscontext.h"
+
+using namespace PAIS;
+
+// SIMD kernels load up to 8 lanes past the last window pixel
+static const int WINDOW_PADDING = 8;
+
+/* constructor */
+
+FitnessContext::FitnessContext(const Patch &patch) {
+	const MVS &mvs = MVS::getInstance();
+	const vector<Camera> &cameras = mvs.getCameras();
+	const vector<int> &camIdx     = patch.getCameraIndices();
+	const Camera &refCam          = mvs.getCamera(patch.getReferenceCameraIndex());
+	const int LOD                 = patch.getLOD();
+
+	this->patch            = &patch;
+	this->evaluate         = mvs.getKernelSet().evaluate;
+	this->camNum           = patch.getCameraNumber();
+	this->inside           = false;
+	this->coarseStride     = max(1, mvs.getCoarseStride());
+	this->ray              = patch.getRay();
+	this->refCenter        = refCam.getCenter();
+	this->refOpticalNormal = refCam.getOpticalNormal();
+
+	// scaled projections shared by all particles
+	camA.resize(camNum);
+	camB.resize(camNum);
+	if (camNum > 0) {
+		patch.getScaledProjections(refA, refB, &camA[0], &camB[0]);
+	}
+
+	// visible camera images
+	images.resize(camNum);
+	for (int i = 0; i < camNum; ++i) {
+		images[i] = FitnessKernel::getImage(cameras[camIdx[i]].getPyramidImage(LOD));
+	}
+
+	window.patchRadius              = mvs.getPatchRadius();
+	window.patchSize                = mvs.getPatchSize();
+	window.camNum                   = camNum;
+	window.H                        = NULL;
+	window.img                      = images.empty() ? NULL : &images[0];
+	window.refIdx                   = -1;
+	window.mask                     = NULL;
+	window.weight                   = NULL;
+	window.refColor                 = NULL;
+	window.rowOrder                 = NULL;
+	window.rowRemain                = NULL;
+	window.rowNum                   = 0;
+	window.bound                    = DBL_MAX;
+	window.adaptiveDifferenceEnable = mvs.isAdaptiveDifferenceEnable();
+	window.diffWeighting            = mvs.getDifferenceWeight();
+	window.diffTable                = &mvs.getDifferenceTable()[0];
+
+	for (int i = 0; i < camNum; ++i) {
+		if (camIdx[i] == patch.getReferenceCameraIndex()) {
+			window.refIdx = i;
+			break;
+		}
+	}
+
+	setWindow();
+}
+
+FitnessContext::~FitnessContext(void) {
+}
+
+/* setter */
+
+void FitnessContext::setWindow() {
+	const MVS &mvs = MVS::getInstance();
+	const Camera &refCam = mvs.getCamera(patch->getReferenceCameraIndex());
+	const int LOD         = patch->getLOD();
+	const int patchRadius = window.patchRadius;
+	const int patchSize   = window.patchSize;
+
+	// reference images
+	const Mat_<uchar>  &refImg     = refCam.getPyramidImage(LOD);
+	const Mat_<double> &distWeight = mvs.getPatchDistanceWeighting();
+	// pre-computed gradient weighting of reference image
+	const Mat_<float> gradientWeight = mvs.isAdaptiveGradientEnable() ? refCam.getPyramidGradientWeight(LOD) : Mat_<float>();
+
+	// projected patch center on reference image, the same for every depth along the ray
+	Vec2d pt;
+	if ( !refCam.project(patch->getCenter(), pt, LOD) ) {
+		return;
+	}
+
+	// skip out of reference image bound patch
+	if (pt[0]-patchRadius < 2 ||
+		pt[0]+patchRadius >= refImg.cols-3 ||
+		pt[1]-patchRadius < 2 ||
+		pt[1]+patchRadius >= refImg.rows-3) {
+		return;
+	}
+
+	vector<uchar>  &mask   = full.mask;
+	vector<double> &weight = full.weight;
+	mask.assign(patchSize*patchSize, 0);
+	weight.assign(patchSize*patchSize, 0);
+	refColor.assign(patchSize*patchSize + WINDOW_PADDING, 0);
+
+	int px[4];                       // neighbor x
+	int py[4];                       // neighbor y
+
+	int i = 0;
+	for (double x = pt[0]-patchRadius; x <= pt[0]+patchRadius; ++x, ++i) {
+		int j = 0;
+		for (double y = pt[1]-patchRadius; y <= pt[1]+patchRadius; ++y, ++j) {
+			const int idx = i*patchSize + j;
+
+			// skip background
+			if (refImg.at<uchar>(cvRound(y), cvRound(x)) == 0) continue;
+			mask[idx] = 1;
+
+			// static weighting
+			double w = 1;
+			if ( mvs.isAdaptiveDistanceEnable() ) {   // adaptive distance weighting
+				w *= distWeight.at<double>(i, j);
+			}
+			if ( mvs.isAdaptiveGradientEnable() ) {   // adaptive gradient maginitude weighting
+				w *= gradientWeight(cvRound(y), cvRound(x));
+			}
+			weight[idx] = w;
+
+			// reference color (identity homography)
+			px[0] = (int) x;
+			py[0] = (int) y;
+			px[1] = px[0] + 1;
+			py[1] = py[0];
+			px[2] = px[0];
+			py[2] = py[0] + 1;
+			px[3] = px[0] + 1;
+			py[3] = py[0] + 1;
+
+			refColor[idx] = (double) refImg.at<uchar>(py[0], px[0])*(px[1]-x)*(py[2]-y) +
+			                (double) refImg.at<uchar>(py[1], px[1])*(x-px[0])*(py[2]-y) +
+			                (double) refImg.at<uchar>(py[2], px[2])*(px[1]-x)*(y-py[0]) +
+			                (double) refImg.at<uchar>(py[3], px[3])*(x-px[0])*(y-py[0]);
+		}
+	}
+
+	window.pt       = pt;
+	window.refColor = &refColor[0];
+	inside = true;
+
+	setRowOrder(full);
+	setCoarseSamples();
+	setSamples(full);
+}
+
+void FitnessContext::setCoarseSamples() {
+	if (coarseStride <= 1) return;
+
+	const int patchRadius = window.patchRadius;
+	const int patchSize   = window.patchSize;
+
+	// keep pixels on stride grid aligned to window center
+	coarse.mask   = full.mask;
+	coarse.weight = full.weight;
+	for (int i = 0; i < patchSize; ++i) {
+		for (int j = 0; j < patchSize; ++j) {
+			if ((i-patchRadius) % coarseStride == 0 && (j-patchRadius) % coarseStride == 0) continue;
+			coarse.mask[i*patchSize + j]   = 0;
+			coarse.weight[i*patchSize + j] = 0;
+		}
+	}
+
+	setRowOrder(coarse);
+}
+
+void FitnessContext::setRowOrder(WindowSamples &samples) {
+	const int patchRadius = window.patchRadius;
+	const int patchSize   = window.patchSize;
+	const vector<double> &weight = samples.weight;
+
+	// static weighting of rows, sorted descending with center-out order for ties
+	vector<pair<double, int> > rows(patchSize);
+	int rowNum = 0;
+	for (int r = 0; r < patchSize; ++r) {
+		// center-out row: radius, radius-1, radius+1, radius-2, ...
+		const int i = patchRadius + ((r % 2 == 0) ? r/2 : -(r+1)/2);
+		// skip rows off coarse sampling grid
+		if (&samples == &coarse && (i-patchRadius) % coarseStride != 0) continue;
+		double rowWeight = 0;
+		for (int j = 0; j < patchSize; ++j) {
+			rowWeight += weight[i*patchSize + j];
+		}
+		rows[rowNum++] = make_pair(-rowWeight, r);
+	}
+	rows.resize(rowNum);
+	sort(rows.begin(), rows.end());
+
+	samples.rowOrder.resize(rowNum);
+	samples.rowRemain.resize(rowNum);
+	double remain = 0;
+	for (int k = rowNum-1; k >= 0; --k) {
+		const int r = rows[k].second;
+		samples.rowOrder[k]  = patchRadius + ((r % 2 == 0) ? r/2 : -(r+1)/2);
+		samples.rowRemain[k] = remain;
+		remain              -= rows[k].first;
+	}
+}
+
+void FitnessContext::setSamples(const WindowSamples &samples) {
+	window.mask      = &samples.mask[0];
+	window.weight    = &samples.weight[0];
+	window.rowOrder  = &samples.rowOrder[0];
+	window.rowRemain = &samples.rowRemain[0];
+	window.rowNum    = (int) samples.rowOrder.size();
+}
+
+void FitnessContext::setCoarse(const bool coarse) {
+	if (!inside) return;
+	setSamples((coarse && coarseStride > 1) ? this->coarse : full);
+}
+
+/* fitness */
+
+double FitnessContext::getFitness(const Vec3d &normal, const Vec3d &center, const double bound, bool &bounded) const {
+	// skip inversed normal
+	if (normal.ddot(refOpticalNormal) > 0) {
+		return DBL_MAX;
+	}
+
+	// Homographies to visible camera
+	ScratchBuffer<Matx33d, FitnessKernel::STACK_CAMERA_NUM> H(camNum);
+	if (camNum > 0) {
+		patch->getHomographies(refA, refB, &camA[0], &camB[0], &center, &normal, 1, &H[0]);
+	}
+
+	FitnessWindow win = window;
+	win.H     = &H[0];
+	win.bound = bound;
+
+	return evaluate(win, bounded);
+}
+
+double FitnessContext::getFitness(const double *pos) const {
+	if (!inside) return DBL_MAX;
+
+	// given patch normal and center
+	Vec3d normal;
+	Utility::spherical2Normal(Vec2d(pos[0], pos[1]), normal);
+	const Vec3d center = ray * pos[2] + refCenter;
+
+	bool stopped = false;
+	return getFitness(normal, center, DBL_MAX, stopped);
+}
+
+void FitnessContext::getFitness(const double *pos, const int num, const double *bound, double *fitness, int *bounded) const {
+	for (int p = 0; p < num; ++p) bounded[p] = 0;
+	if (!inside) {
+		for (int p = 0; p < num; ++p) fitness[p] = DBL_MAX;
+		return;
+	}
+
+	#pragma omp parallel for
+	for (int p = 0; p < num; ++p) {
+		// given patch normal and center of particle
+		Vec3d normal;
+		Utility::spherical2Normal(Vec2d(pos[p], pos[num + p]), normal);
+		const Vec3d center = ray * pos[2*num + p] + refCenter;
+
+		bool stopped = false;
+		fitness[p] = getFitness(normal, center, (bound != NULL) ? bound[p] : DBL_MAX, stopped);
+		bounded[p] = stopped ? 1 : 0;
+	}
+}
\ No newline at end of file
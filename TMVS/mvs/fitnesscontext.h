@@ -0,0 +1,75 @@
+#ifndef __PAIS_FITNESS_CONTEXT_H__
+#define __PAIS_FITNESS_CONTEXT_H__
+
+#include "fitnesskernel.h"
+#include "patch.h"
+
+using namespace std;
+using namespace cv;
+
+namespace PAIS {
+	class Patch;
+
+	// patch invariant part of fitness function, built once per optimization
+	class FitnessContext {
+	private:
+		const Patch *patch;
+		// fitness function of selected kernel and patch radius
+		double (*evaluate)(const FitnessWindow &win, bool &bounded);
+		// visible camera number
+		int camNum;
+		// window is inside reference image
+		bool inside;
+		// patch ray and reference camera
+		Vec3d ray;
+		Vec3d refCenter;
+		Vec3d refOpticalNormal;
+		// LOD scaled K*R and K*T of reference and visible cameras, see Patch::getScaledProjections()
+		Matx33d refA;
+		Vec3d   refB;
+		vector<Matx33d> camA;
+		vector<Vec3d>   camB;
+		// visible camera images on patch LOD
+		vector<FitnessImage> images;
+		// reference color of window pixels (patchSize*patchSize)
+		vector<double> refColor;
+		// sampled window pixels of full and coarse evaluation
+		struct WindowSamples {
+			// pixel mask and static weighting (patchSize*patchSize)
+			vector<uchar>  mask;
+			vector<double> weight;
+			// visited rows in visiting order and static weighting of rows left after each (rowNum)
+			vector<int>    rowOrder;
+			vector<double> rowRemain;
+		};
+		WindowSamples full;
+		WindowSamples coarse;
+		// coarse sampling stride (1 for full window only)
+		int coarseStride;
+		// sampling window without homographies
+		FitnessWindow window;
+
+		void setWindow();
+		void setCoarseSamples();
+		void setRowOrder(WindowSamples &samples);
+		void setSamples(const WindowSamples &samples);
+		// fitness of one particle (normal, center)
+		double getFitness(const Vec3d &normal, const Vec3d &center, const double bound, bool &bounded) const;
+
+	public:
+		FitnessContext(const Patch &patch);
+		~FitnessContext(void);
+
+		// window is inside reference image (fitness is DBL_MAX otherwise)
+		bool isInside() const { return inside; }
+		// evaluate stratified subset of every coarseStride-th window row and column, or full window
+		void setCoarse(const bool coarse);
+		// fitness of particle position (theta, phi, depth)
+		double getFitness(const double *pos) const;
+		// fitness of num particles (pos: theta, phi and depth arrays of num)
+		// evaluation stops at bound of each particle (NULL for full evaluation), bounded marks lower bound results
+		void getFitness(const double *pos, const int num, const double *bound, double *fitness, int *bounded) const;
+	};
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,687 @@
+#include "fitnesskernel.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define PAIS_FITNESS_SIMD
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define PAIS_TARGET_SSE4
+		#define PAIS_TARGET_AVX2
+	#else
+		#define PAIS_TARGET_SSE4 __attribute__((target("sse4.1")))
+		#define PAIS_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+using namespace PAIS;
+
+// bilinear color scratch of visible cameras (per lane for SIMD kernels)
+typedef ScratchBuffer<double, FitnessKernel::STACK_CAMERA_NUM>   ColorBuffer;
+typedef ScratchBuffer<float,  FitnessKernel::STACK_CAMERA_NUM*4> ColorBuffer4;
+typedef ScratchBuffer<float,  FitnessKernel::STACK_CAMERA_NUM*8> ColorBuffer8;
+
+/* weighting */
+
+// linear interpolation of difference weighting table
+static inline double getTableWeight(const float *table, const double avgSad) {
+	const double s = min(max(avgSad, 0.0), 255.0) * FitnessKernel::DIFF_TABLE_SCALE;
+	const int    i = min((int) s, FitnessKernel::DIFF_TABLE_SIZE-2);
+	const double f = s - i;
+	return table[i] + f*(table[i+1] - table[i]);
+}
+
+// adaptive difference weighting exp(-avgSad*avgSad/diffWeighting)
+static inline double getDifferenceWeight(const FitnessWindow &win, const double avgSad) {
+	if (win.diffTable == NULL) {
+		return exp(-avgSad*avgSad/win.diffWeighting);
+	}
+	return getTableWeight(win.diffTable, avgSad);
+}
+
+// accumulate weighted average SAD of window pixel idx
+static inline void accumulateWeight(const FitnessWindow &win, const int idx, const double avgSad, const double diffWeight, double &fitness, double &sumWeight) {
+	// static distance and gradient weighting with adaptive difference weighting
+	const double weight = win.weight[idx] * diffWeight;
+	sumWeight += weight;
+	fitness   += weight * avgSad;
+}
+
+// check fitness cannot be lower than bound after k-th visited row
+// remaining pixels add non-negative SAD with at most their static weighting
+static inline bool isBounded(const FitnessWindow &win, const int k, const double fitness, const double sumWeight, double &lowerBound) {
+	if (win.bound == DBL_MAX || k+1 == win.rowNum) return false;
+
+	const double maxWeight = sumWeight + win.rowRemain[k];
+	if (maxWeight <= 0 || fitness < win.bound * maxWeight) return false;
+
+	lowerBound = fitness / maxWeight;
+	return true;
+}
+
+/* scalar kernels
+ * Kernels are specialized for patch radius R (R = 0 reads the radius from arguments),
+ * so window loops of common radii have compile-time bounds.
+ */
+
+template <int R>
+static double evaluateScalar(const FitnessWindow &win, bool &bounded) {
+	const int patchRadius   = (R > 0) ? R : win.patchRadius;
+	const int patchSize     = 2*patchRadius + 1;
+	const int camNum        = win.camNum;
+	const Vec2d &pt         = win.pt;
+
+	double mean, avgSad;             // pixel-wised mean, average sad
+	double w, ix, iy;                // position on target image
+	int px[4];                       // neighbor x
+	int py[4];                       // neighbor y
+	ColorBuffer c(camNum);           // bilinear color
+	double fitness = 0;              // result of normalized fitness
+	double sumWeight = 0;
+	double lowerBound;
+
+	for (int k = 0; k < win.rowNum; ++k) {
+		const int i    = win.rowOrder[k];
+		const double x = pt[0] - patchRadius + i;
+		for (int j = 0; j < patchSize; ++j) {
+			const double y = pt[1] - patchRadius + j;
+			const int idx = i*patchSize + j;
+
+			// clear
+			mean   = 0;
+			avgSad = 0;
+
+			// skip background
+			if (win.mask[idx] == 0) continue;
+
+			for (int n = 0; n < camNum; ++n) {
+				// reference color does not need warping
+				if (n == win.refIdx) {
+					c[n] = win.refColor[idx];
+					mean += c[n];
+					continue;
+				}
+
+				const FitnessImage &img = win.img[n];
+				const double *H = win.H[n].val;
+
+				// homography projection
+				w  = ( H[6] * x + H[7] * y + H[8] );
+				ix = ( H[0] * x + H[1] * y + H[2] ) / w;
+				iy = ( H[3] * x + H[4] * y + H[5] ) / w;
+
+				// skip overflow cases
+				if (ix < 2 || ix >= img.cols-3 || iy < 2 || iy >= img.rows-3 || w == 0) {
+					return DBL_MAX;
+				}
+
+				// interpolation neighbor points
+				px[0] = (int) ix;
+				py[0] = (int) iy;
+				px[1] = px[0] + 1;
+				py[1] = py[0];
+				px[2] = px[0];
+				py[2] = py[0] + 1;
+				px[3] = px[0] + 1;
+				py[3] = py[0] + 1;
+
+				c[n] = (double) img.data[py[0]*img.step + px[0]]*(px[1]-ix)*(py[2]-iy) +
+				       (double) img.data[py[1]*img.step + px[1]]*(ix-px[0])*(py[2]-iy) +
+				       (double) img.data[py[2]*img.step + px[2]]*(px[1]-ix)*(iy-py[0]) +
+				       (double) img.data[py[3]*img.step + px[3]]*(ix-px[0])*(iy-py[0]);
+
+				mean += c[n];
+			} // end of camera
+
+			mean /= camNum;
+
+			for (int n = 0; n < camNum; n++) {
+				avgSad += abs(c[n]-mean);
+			}
+			avgSad /= camNum;
+
+			accumulateWeight(win, idx, avgSad, win.adaptiveDifferenceEnable ? getDifferenceWeight(win, avgSad) : 1.0, fitness, sumWeight);
+		} // end of warping y
+
+		if ( isBounded(win, k, fitness, sumWeight, lowerBound) ) {
+			bounded = true;
+			return lowerBound;
+		}
+	} // end of warping x
+
+	return fitness / sumWeight;
+}
+
+// bilinear color of image at (ix, iy)
+static inline double getBilinearColor(const FitnessImage &img, const double ix, const double iy) {
+	const int    px = (int) ix;
+	const int    py = (int) iy;
+	const double fx = ix - px;
+	const double fy = iy - py;
+	const uchar *p  = img.data + py*img.step + px;
+
+	return (double) p[0]           *(1-fx)*(1-fy) +
+	       (double) p[1]           *   fx *(1-fy) +
+	       (double) p[img.step]    *(1-fx)*   fy  +
+	       (double) p[img.step + 1]*   fx *   fy;
+}
+
+template <int R>
+static bool warpWindow(const FitnessImage &img, const Matx33d &homography, const Vec2d &pt, const int radius, double *color) {
+	const int patchRadius = (R > 0) ? R : radius;
+	const int patchSize   = 2*patchRadius + 1;
+	const double *H       = homography.val;
+
+	double w, ix, iy;                // position on target image
+	for (int i = 0; i < patchSize; ++i) {
+		const double x = pt[0] - patchRadius + i;
+		for (int j = 0; j < patchSize; ++j) {
+			const double y = pt[1] - patchRadius + j;
+
+			// homography projection
+			w  = ( H[6] * x + H[7] * y + H[8] );
+			ix = ( H[0] * x + H[1] * y + H[2] ) / w;
+			iy = ( H[3] * x + H[4] * y + H[5] ) / w;
+
+			// skip overflow cases
+			if (ix < 0 || ix >= img.cols-1 || iy < 0 || iy >= img.rows-1 || w == 0) {
+				return false;
+			}
+
+			color[i*patchSize + j] = getBilinearColor(img, ix, iy);
+		}
+	}
+
+	return true;
+}
+
+template <int R>
+static bool getWindowSad(const FitnessImage *img, const Matx33d *homography, const int camNum, const Vec2d &pt, const int radius, double *sad) {
+	const int patchRadius = (R > 0) ? R : radius;
+	const int patchSize   = 2*patchRadius + 1;
+
+	double mean, avgSad;             // pixel-wised mean, average sad
+	double w, ix, iy;                // position on target image
+	ColorBuffer c(camNum);           // bilinear color
+
+	for (int i = 0; i < patchSize; ++i) {
+		const double x = pt[0] - patchRadius + i;
+		for (int j = 0; j < patchSize; ++j) {
+			const double y = pt[1] - patchRadius + j;
+
+			// clear
+			mean   = 0;
+			avgSad = 0;
+
+			for (int n = 0; n < camNum; ++n) {
+				const double *H = homography[n].val;
+
+				// homography projection
+				w  = ( H[6] * x + H[7] * y + H[8] );
+				ix = ( H[0] * x + H[1] * y + H[2] ) / w;
+				iy = ( H[3] * x + H[4] * y + H[5] ) / w;
+
+				// all interpolation neighbor points in image
+				const int px = (int) ix;
+				const int py = (int) iy;
+				if (!(px >= 0 && px+1 < img[n].cols && py >= 0 && py+1 < img[n].rows)) {
+					return false;
+				}
+
+				c[n] = getBilinearColor(img[n], ix, iy);
+				mean += c[n];
+			} // end of camera
+
+			mean /= camNum;
+
+			for (int n = 0; n < camNum; ++n) {
+				avgSad += abs(c[n]-mean);
+			}
+			sad[i*patchSize + j] = avgSad / camNum;
+		} // end of warping y
+	} // end of warping x
+
+	return true;
+}
+
+#ifdef PAIS_FITNESS_SIMD
+
+/* SIMD kernels
+ * A window column (fixed x) is processed in lanes of consecutive y, so the homography
+ * numerators and denominator only advance by H[1], H[4], H[7] per lane. Warping and
+ * bilinear interpolation run in single precision, the weighting is accumulated in double.
+ */
+
+// difference weighting of lanes (table lookup in vector registers, see getDifferenceWeight())
+PAIS_TARGET_SSE4
+static inline void getDifferenceWeights4(const FitnessWindow &win, const __m128 sad, float *diffWeight) {
+	if ( !win.adaptiveDifferenceEnable ) {
+		_mm_storeu_ps(diffWeight, _mm_set1_ps(1.0f));
+		return;
+	}
+	if (win.diffTable == NULL) {
+		float s[4];
+		_mm_storeu_ps(s, sad);
+		for (int k = 0; k < 4; ++k) diffWeight[k] = (float) exp(-(double) s[k]*s[k]/win.diffWeighting);
+		return;
+	}
+
+	const __m128  s   = _mm_mul_ps(_mm_min_ps(_mm_max_ps(sad, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps((float) FitnessKernel::DIFF_TABLE_SCALE));
+	const __m128i idx = _mm_min_epi32(_mm_cvttps_epi32(s), _mm_set1_epi32(FitnessKernel::DIFF_TABLE_SIZE-2));
+	const __m128  f   = _mm_sub_ps(s, _mm_cvtepi32_ps(idx));
+	int i[4];
+	_mm_storeu_si128((__m128i*) i, idx);
+	const float *t = win.diffTable;
+	const __m128 t0 = _mm_setr_ps(t[i[0]]  , t[i[1]]  , t[i[2]]  , t[i[3]]  );
+	const __m128 t1 = _mm_setr_ps(t[i[0]+1], t[i[1]+1], t[i[2]+1], t[i[3]+1]);
+	_mm_storeu_ps(diffWeight, _mm_add_ps(t0, _mm_mul_ps(f, _mm_sub_ps(t1, t0))));
+}
+
+PAIS_TARGET_AVX2
+static inline void getDifferenceWeights8(const FitnessWindow &win, const __m256 sad, float *diffWeight) {
+	if ( !win.adaptiveDifferenceEnable ) {
+		_mm256_storeu_ps(diffWeight, _mm256_set1_ps(1.0f));
+		return;
+	}
+	if (win.diffTable == NULL) {
+		float s[8];
+		_mm256_storeu_ps(s, sad);
+		for (int k = 0; k < 8; ++k) diffWeight[k] = (float) exp(-(double) s[k]*s[k]/win.diffWeighting);
+		return;
+	}
+
+	const __m256  s   = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(sad, _mm256_setzero_ps()), _mm256_set1_ps(255.0f)), _mm256_set1_ps((float) FitnessKernel::DIFF_TABLE_SCALE));
+	const __m256i idx = _mm256_min_epi32(_mm256_cvttps_epi32(s), _mm256_set1_epi32(FitnessKernel::DIFF_TABLE_SIZE-2));
+	const __m256  f   = _mm256_sub_ps(s, _mm256_cvtepi32_ps(idx));
+	const __m256  t0  = _mm256_i32gather_ps(win.diffTable, idx, 4);
+	const __m256  t1  = _mm256_i32gather_ps(win.diffTable + 1, idx, 4);
+	_mm256_storeu_ps(diffWeight, _mm256_add_ps(t0, _mm256_mul_ps(f, _mm256_sub_ps(t1, t0))));
+}
+
+// mark lanes inside window and not in background, return false if no lane is valid
+static inline bool getValidLanes(const FitnessWindow &win, const int idx, const int laneNum, const int lanes, int *valid) {
+	bool any = false;
+	for (int k = 0; k < lanes; ++k) {
+		valid[k] = 0;
+		if (k >= laneNum) continue;
+		if (win.mask[idx+k] == 0) continue;
+		valid[k] = -1;
+		any = true;
+	}
+	return any;
+}
+
+template <int R>
+PAIS_TARGET_SSE4
+static double evaluateSSE4(const FitnessWindow &win, bool &bounded) {
+	const int patchRadius = (R > 0) ? R : win.patchRadius;
+	const int patchSize   = 2*patchRadius + 1;
+	const int camNum      = win.camNum;
+
+	const __m128 laneIdx   = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+	const __m128 zero      = _mm_setzero_ps();
+	const __m128 two       = _mm_set1_ps(2.0f);
+	const __m128 invCamNum = _mm_set1_ps(1.0f / camNum);
+	const __m128 absMask   = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+	ColorBuffer4 c(camNum*4);        // bilinear color of lanes
+	int   valid[4];                  // valid lane mask
+	int   px[4], py[4];              // top left neighbor of lanes
+	float sad[4];                    // average sad of lanes
+	float diffWeight[4];             // difference weighting of lanes
+	double fitness = 0;              // result of normalized fitness
+	double sumWeight = 0;
+	double lowerBound;
+
+	for (int r = 0; r < win.rowNum; ++r) {
+		const int    i  = win.rowOrder[r];
+		const double x  = win.pt[0] - patchRadius + i;
+
+		for (int j = 0; j < patchSize; j += 4) {
+			const double y0 = win.pt[1] - patchRadius + j;
+			const int laneNum = min(4, patchSize - j);
+			const int idx     = i*patchSize + j;
+
+			if ( !getValidLanes(win, idx, laneNum, 4, valid) ) continue;
+			const __m128 validMask = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) valid));
+
+			__m128 sum = zero;
+			for (int n = 0; n < camNum; ++n) {
+				// reference color does not need warping
+				if (n == win.refIdx) {
+					const double *rc   = win.refColor + idx;
+					const __m128 color = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(rc)), _mm_cvtpd_ps(_mm_loadu_pd(rc+2)));
+					_mm_storeu_ps(&c[n*4], color);
+					sum = _mm_add_ps(sum, color);
+					continue;
+				}
+
+				const FitnessImage &img = win.img[n];
+				const double *H = win.H[n].val;
+
+				// homography projection
+				const __m128 w  = _mm_add_ps(_mm_set1_ps((float) (H[6]*x + H[7]*y0 + H[8])), _mm_mul_ps(laneIdx, _mm_set1_ps((float) H[7])));
+				const __m128 ix = _mm_div_ps(_mm_add_ps(_mm_set1_ps((float) (H[0]*x + H[1]*y0 + H[2])), _mm_mul_ps(laneIdx, _mm_set1_ps((float) H[1]))), w);
+				const __m128 iy = _mm_div_ps(_mm_add_ps(_mm_set1_ps((float) (H[3]*x + H[4]*y0 + H[5])), _mm_mul_ps(laneIdx, _mm_set1_ps((float) H[4]))), w);
+
+				// skip overflow cases
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(ix, two), _mm_cmplt_ps(ix, _mm_set1_ps((float) (img.cols-3))));
+				inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(iy, two), _mm_cmplt_ps(iy, _mm_set1_ps((float) (img.rows-3)))));
+				inside = _mm_and_ps(inside, _mm_cmpneq_ps(w, zero));
+				if (_mm_movemask_ps(_mm_andnot_ps(inside, validMask)) != 0) {
+					return DBL_MAX;
+				}
+
+				// interpolation neighbor points (invalid lanes sample a safe position)
+				const __m128  sx  = _mm_blendv_ps(two, ix, validMask);
+				const __m128  sy  = _mm_blendv_ps(two, iy, validMask);
+				const __m128i pxi = _mm_cvttps_epi32(sx);
+				const __m128i pyi = _mm_cvttps_epi32(sy);
+				const __m128  fx  = _mm_sub_ps(sx, _mm_cvtepi32_ps(pxi));
+				const __m128  fy  = _mm_sub_ps(sy, _mm_cvtepi32_ps(pyi));
+				_mm_storeu_si128((__m128i*) px, pxi);
+				_mm_storeu_si128((__m128i*) py, pyi);
+
+				const uchar *p[4];
+				for (int k = 0; k < 4; ++k) {
+					p[k] = img.data + py[k]*img.step + px[k];
+				}
+				const __m128 p00 = _mm_setr_ps(p[0][0]             , p[1][0]             , p[2][0]             , p[3][0]             );
+				const __m128 p01 = _mm_setr_ps(p[0][1]             , p[1][1]             , p[2][1]             , p[3][1]             );
+				const __m128 p10 = _mm_setr_ps(p[0][img.step]      , p[1][img.step]      , p[2][img.step]      , p[3][img.step]      );
+				const __m128 p11 = _mm_setr_ps(p[0][img.step+1]    , p[1][img.step+1]    , p[2][img.step+1]    , p[3][img.step+1]    );
+
+				// bilinear interpolation
+				const __m128 top    = _mm_add_ps(p00, _mm_mul_ps(fx, _mm_sub_ps(p01, p00)));
+				const __m128 bottom = _mm_add_ps(p10, _mm_mul_ps(fx, _mm_sub_ps(p11, p10)));
+				const __m128 color  = _mm_add_ps(top, _mm_mul_ps(fy, _mm_sub_ps(bottom, top)));
+
+				_mm_storeu_ps(&c[n*4], color);
+				sum = _mm_add_ps(sum, color);
+			} // end of camera
+
+			// pixel-wised mean and average sad
+			const __m128 mean = _mm_mul_ps(sum, invCamNum);
+			__m128 avgSad = zero;
+			for (int n = 0; n < camNum; ++n) {
+				avgSad = _mm_add_ps(avgSad, _mm_and_ps(absMask, _mm_sub_ps(_mm_loadu_ps(&c[n*4]), mean)));
+			}
+			avgSad = _mm_mul_ps(avgSad, invCamNum);
+			_mm_storeu_ps(sad, avgSad);
+			getDifferenceWeights4(win, avgSad, diffWeight);
+
+			for (int k = 0; k < laneNum; ++k) {
+				if ( !valid[k] ) continue;
+				accumulateWeight(win, idx+k, sad[k], diffWeight[k], fitness, sumWeight);
+			}
+		} // end of warping y
+
+		if ( isBounded(win, r, fitness, sumWeight, lowerBound) ) {
+			bounded = true;
+			return lowerBound;
+		}
+	} // end of warping x
+
+	return fitness / sumWeight;
+}
+
+template <int R>
+PAIS_TARGET_AVX2
+static double evaluateAVX2(const FitnessWindow &win, bool &bounded) {
+	const int patchRadius = (R > 0) ? R : win.patchRadius;
+	const int patchSize   = 2*patchRadius + 1;
+	const int camNum      = win.camNum;
+
+	const __m256  laneIdx   = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+	const __m256  zero      = _mm256_setzero_ps();
+	const __m256  two       = _mm256_set1_ps(2.0f);
+	const __m256  invCamNum = _mm256_set1_ps(1.0f / camNum);
+	const __m256  absMask   = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256i byteMask  = _mm256_set1_epi32(0xff);
+
+	ColorBuffer8 c(camNum*8);        // bilinear color of lanes
+	int   valid[8];                  // valid lane mask
+	float sad[8];                    // average sad of lanes
+	float diffWeight[8];             // difference weighting of lanes
+	double fitness = 0;              // result of normalized fitness
+	double sumWeight = 0;
+	double lowerBound;
+
+	for (int r = 0; r < win.rowNum; ++r) {
+		const int    i  = win.rowOrder[r];
+		const double x  = win.pt[0] - patchRadius + i;
+
+		for (int j = 0; j < patchSize; j += 8) {
+			const double y0 = win.pt[1] - patchRadius + j;
+			const int laneNum = min(8, patchSize - j);
+			const int idx     = i*patchSize + j;
+
+			if ( !getValidLanes(win, idx, laneNum, 8, valid) ) continue;
+			const __m256 validMask = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*) valid));
+
+			__m256 sum = zero;
+			for (int n = 0; n < camNum; ++n) {
+				// reference color does not need warping
+				if (n == win.refIdx) {
+					const double *rc   = win.refColor + idx;
+					const __m256 color = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_loadu_pd(rc))), _mm256_cvtpd_ps(_mm256_loadu_pd(rc+4)), 1);
+					_mm256_storeu_ps(&c[n*8], color);
+					sum = _mm256_add_ps(sum, color);
+					continue;
+				}
+
+				const FitnessImage &img = win.img[n];
+				const double *H = win.H[n].val;
+
+				// homography projection
+				const __m256 w  = _mm256_add_ps(_mm256_set1_ps((float) (H[6]*x + H[7]*y0 + H[8])), _mm256_mul_ps(laneIdx, _mm256_set1_ps((float) H[7])));
+				const __m256 ix = _mm256_div_ps(_mm256_add_ps(_mm256_set1_ps((float) (H[0]*x + H[1]*y0 + H[2])), _mm256_mul_ps(laneIdx, _mm256_set1_ps((float) H[1]))), w);
+				const __m256 iy = _mm256_div_ps(_mm256_add_ps(_mm256_set1_ps((float) (H[3]*x + H[4]*y0 + H[5])), _mm256_mul_ps(laneIdx, _mm256_set1_ps((float) H[4]))), w);
+
+				// skip overflow cases
+				__m256 inside = _mm256_and_ps(_mm256_cmp_ps(ix, two, _CMP_GE_OQ), _mm256_cmp_ps(ix, _mm256_set1_ps((float) (img.cols-3)), _CMP_LT_OQ));
+				inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(iy, two, _CMP_GE_OQ), _mm256_cmp_ps(iy, _mm256_set1_ps((float) (img.rows-3)), _CMP_LT_OQ)));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(w, zero, _CMP_NEQ_OQ));
+				if (_mm256_movemask_ps(_mm256_andnot_ps(inside, validMask)) != 0) {
+					return DBL_MAX;
+				}
+
+				// interpolation neighbor points (invalid lanes sample a safe position)
+				const __m256  sx  = _mm256_blendv_ps(two, ix, validMask);
+				const __m256  sy  = _mm256_blendv_ps(two, iy, validMask);
+				const __m256i pxi = _mm256_cvttps_epi32(sx);
+				const __m256i pyi = _mm256_cvttps_epi32(sy);
+				const __m256  fx  = _mm256_sub_ps(sx, _mm256_cvtepi32_ps(pxi));
+				const __m256  fy  = _mm256_sub_ps(sy, _mm256_cvtepi32_ps(pyi));
+
+				// gather 4 bytes from top and bottom rows (px <= cols-4 and py <= rows-4 by the bound check)
+				const __m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(pyi, _mm256_set1_epi32(img.step)), pxi);
+				const __m256i top4   = _mm256_i32gather_epi32((const int*) img.data, offset, 1);
+				const __m256i bot4   = _mm256_i32gather_epi32((const int*) (img.data + img.step), offset, 1);
+				const __m256  p00    = _mm256_cvtepi32_ps(_mm256_and_si256(top4, byteMask));
+				const __m256  p01    = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(top4, 8), byteMask));
+				const __m256  p10    = _mm256_cvtepi32_ps(_mm256_and_si256(bot4, byteMask));
+				const __m256  p11    = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(bot4, 8), byteMask));
+
+				// bilinear interpolation
+				const __m256 top    = _mm256_add_ps(p00, _mm256_mul_ps(fx, _mm256_sub_ps(p01, p00)));
+				const __m256 bottom = _mm256_add_ps(p10, _mm256_mul_ps(fx, _mm256_sub_ps(p11, p10)));
+				const __m256 color  = _mm256_add_ps(top, _mm256_mul_ps(fy, _mm256_sub_ps(bottom, top)));
+
+				_mm256_storeu_ps(&c[n*8], color);
+				sum = _mm256_add_ps(sum, color);
+			} // end of camera
+
+			// pixel-wised mean and average sad
+			const __m256 mean = _mm256_mul_ps(sum, invCamNum);
+			__m256 avgSad = zero;
+			for (int n = 0; n < camNum; ++n) {
+				avgSad = _mm256_add_ps(avgSad, _mm256_and_ps(absMask, _mm256_sub_ps(_mm256_loadu_ps(&c[n*8]), mean)));
+			}
+			avgSad = _mm256_mul_ps(avgSad, invCamNum);
+			_mm256_storeu_ps(sad, avgSad);
+			getDifferenceWeights8(win, avgSad, diffWeight);
+
+			for (int k = 0; k < laneNum; ++k) {
+				if ( !valid[k] ) continue;
+				accumulateWeight(win, idx+k, sad[k], diffWeight[k], fitness, sumWeight);
+			}
+		} // end of warping y
+
+		if ( isBounded(win, r, fitness, sumWeight, lowerBound) ) {
+			bounded = true;
+			return lowerBound;
+		}
+	} // end of warping x
+
+	return fitness / sumWeight;
+}
+
+// query CPU features once
+static void getCpuFeatures(bool &sse4, bool &avx2) {
+	sse4 = false;
+	avx2 = false;
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxId = info[0];
+	__cpuid(info, 1);
+	sse4 = (info[2] & (1 << 19)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx     = (info[2] & (1 << 28)) != 0;
+	// OS must save YMM registers
+	if (maxId >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	sse4 = __builtin_cpu_supports("sse4.1") != 0;
+	avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif
+
+// kernel set specialized for patch radius R
+template <int R>
+static FitnessKernel::KernelSet getKernelSet(const int kernel) {
+	FitnessKernel::KernelSet set;
+	set.patchRadius = R;
+	set.warp        = warpWindow<R>;
+	set.sad         = getWindowSad<R>;
+
+	switch (kernel) {
+#ifdef PAIS_FITNESS_SIMD
+	case FitnessKernel::KERNEL_AVX2:
+		set.evaluate = evaluateAVX2<R>;
+		break;
+	case FitnessKernel::KERNEL_SSE4:
+		set.evaluate = evaluateSSE4<R>;
+		break;
+#endif
+	default:
+	case FitnessKernel::KERNEL_SCALAR:
+		set.evaluate = evaluateScalar<R>;
+		break;
+	}
+
+	return set;
+}
+
+/* public functions */
+
+FitnessImage FitnessKernel::getImage(const Mat &img) {
+	FitnessImage view;
+	view.data = img.data;
+	view.step = (int) img.step;
+	view.cols = img.cols;
+	view.rows = img.rows;
+	return view;
+}
+
+bool FitnessKernel::isSupported(const int kernel) {
+	switch (kernel) {
+	case KERNEL_SCALAR:
+		return true;
+#ifdef PAIS_FITNESS_SIMD
+	case KERNEL_SSE4:
+	case KERNEL_AVX2:
+		{
+			bool sse4, avx2;
+			getCpuFeatures(sse4, avx2);
+			return (kernel == KERNEL_SSE4) ? sse4 : avx2;
+		}
+#endif
+	default:
+		return false;
+	}
+}
+
+int FitnessKernel::resolve(const int kernel) {
+	// unknown kernel falls back to scalar
+	if (kernel < KERNEL_SCALAR || kernel > KERNEL_AUTO) return KERNEL_SCALAR;
+
+	int k = (kernel == KERNEL_AUTO) ? KERNEL_AVX2 : kernel;
+	while (k > KERNEL_SCALAR && !isSupported(k)) {
+		--k;
+	}
+	return k;
+}
+
+const char* FitnessKernel::getName(const int kernel) {
+	switch (kernel) {
+	default:
+	case KERNEL_SCALAR:
+		return "Scalar";
+	case KERNEL_SSE4:
+		return "SSE4";
+	case KERNEL_AVX2:
+		return "AVX2";
+	case KERNEL_AUTO:
+		return "Auto";
+	}
+}
+
+void FitnessKernel::getDifferenceTable(const double diffWeighting, vector<float> &table) {
+	table.resize(DIFF_TABLE_SIZE);
+	for (int i = 0; i < DIFF_TABLE_SIZE; ++i) {
+		const double sad = (double) i / DIFF_TABLE_SCALE;
+		table[i] = (float) exp(-sad*sad/diffWeighting);
+	}
+}
+
+bool FitnessKernel::testDifferenceTable(const double diffWeighting, const vector<float> &table) {
+	if ((int) table.size() != DIFF_TABLE_SIZE) return false;
+
+	// interpolation error bound with half float epsilon for rounding of table entries
+	const double maxError = 1.0 / (4*diffWeighting*DIFF_TABLE_SCALE*DIFF_TABLE_SCALE) + FLT_EPSILON/2;
+
+	// 16 samples between table entries
+	const int sampleScale = DIFF_TABLE_SCALE*16;
+	for (int k = 0; k <= 255*sampleScale; ++k) {
+		const double sad = (double) k / sampleScale;
+		if ( fabs(getTableWeight(&table[0], sad) - exp(-sad*sad/diffWeighting)) > maxError ) return false;
+	}
+	return true;
+}
+
+FitnessKernel::KernelSet FitnessKernel::select(const int kernel, const int patchRadius) {
+	switch (patchRadius) {
+	case 7:
+		return getKernelSet<7>(kernel);
+	case 11:
+		return getKernelSet<11>(kernel);
+	case 15:
+		return getKernelSet<15>(kernel);
+	default:
+		return getKernelSet<0>(kernel);
+	}
+}
+
+double FitnessKernel::evaluate(const int kernel, const FitnessWindow &win, bool *bounded) {
+	bool stopped = false;
+	const double fitness = select(kernel, win.patchRadius).evaluate(win, stopped);
+
+	if (bounded != NULL) *bounded = stopped;
+	return fitness;
+}
\ No newline at end of file
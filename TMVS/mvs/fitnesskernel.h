@@ -0,0 +1,135 @@
+#ifndef __PAIS_FITNESS_KERNEL_H__
+#define __PAIS_FITNESS_KERNEL_H__
+
+#include <vector>
+#include <opencv2\opencv.hpp>
+
+#if defined(_MSC_VER)
+	#define PAIS_ALIGN(n) __declspec(align(n))
+#else
+	#define PAIS_ALIGN(n) __attribute__((aligned(n)))
+#endif
+
+using namespace std;
+using namespace cv;
+
+namespace PAIS {
+	// scratch array of fitness evaluation, on stack up to N elements and on heap beyond
+	template <class T, int N>
+	class ScratchBuffer {
+	private:
+		PAIS_ALIGN(32) T stackData[N];
+		vector<T> heapData;
+		T *data;
+
+		ScratchBuffer(const ScratchBuffer &buffer);
+		ScratchBuffer& operator=(const ScratchBuffer &buffer);
+
+	public:
+		ScratchBuffer(const int size) {
+			data = stackData;
+			if (size > N) {
+				heapData.resize(size);
+				data = &heapData[0];
+			}
+		}
+
+		T& operator[](const int i)             { return data[i]; }
+		const T& operator[](const int i) const { return data[i]; }
+	};
+
+	// raw 8-bit image view used by fitness kernels
+	struct FitnessImage {
+		const uchar *data;
+		// row stride in bytes
+		int step;
+		int cols;
+		int rows;
+	};
+
+	// sampling window of a fitness evaluation
+	struct FitnessWindow {
+		// projected patch center on reference image (with LOD transform)
+		Vec2d pt;
+		// patch radius and size (2*radius+1)
+		int patchRadius;
+		int patchSize;
+		// visible camera number
+		int camNum;
+		// homographies from reference to visible images (camNum)
+		const Matx33d *H;
+		// visible camera images on patch LOD (camNum)
+		const FitnessImage *img;
+		// index of reference camera in visible cameras (-1 if not visible)
+		int refIdx;
+		// sampled window pixels, zero for background (patchSize*patchSize)
+		const uchar *mask;
+		// static distance and gradient weighting of window pixels (patchSize*patchSize)
+		const double *weight;
+		// reference image color of window pixels (patchSize*patchSize, padded by 8)
+		const double *refColor;
+		// window rows in visiting order, heaviest static weighting first (rowNum)
+		const int *rowOrder;
+		// static weighting of rows not visited yet after each row in visiting order (rowNum)
+		const double *rowRemain;
+		// number of visited rows (at most patchSize)
+		int rowNum;
+		// stop once fitness cannot be lower than bound (DBL_MAX for full evaluation)
+		double bound;
+		// adaptive difference weighting
+		bool adaptiveDifferenceEnable;
+		double diffWeighting;
+		// difference weighting table (NULL for exact exp), see FitnessKernel::getDifferenceTable()
+		const float *diffTable;
+	};
+
+	class FitnessKernel {
+	public:
+		// visible camera number held by stack scratch buffers (heap beyond)
+		static const int STACK_CAMERA_NUM = 16;
+
+		// kernel implementations
+		static const int KERNEL_SCALAR = 0x00;
+		static const int KERNEL_SSE4   = 0x01;
+		static const int KERNEL_AVX2   = 0x02;
+		static const int KERNEL_AUTO   = 0x03;
+
+		// get image view of 8-bit image
+		static FitnessImage getImage(const Mat &img);
+		// check kernel is supported by current CPU
+		static bool isSupported(const int kernel);
+		// get best supported kernel not above requested one (KERNEL_AUTO for the best one)
+		static int resolve(const int kernel);
+		// get kernel name
+		static const char* getName(const int kernel);
+
+		// difference weighting table samples per SAD unit and table size (SAD 0~255)
+		static const int DIFF_TABLE_SCALE = 8;
+		static const int DIFF_TABLE_SIZE  = 255*DIFF_TABLE_SCALE + 1;
+		// tabulate exp(-sad*sad/diffWeighting) for linear interpolation,
+		// absolute error is at most 1/(4*diffWeighting*DIFF_TABLE_SCALE^2) plus float rounding
+		static void getDifferenceTable(const double diffWeighting, vector<float> &table);
+		// self-test of table against exp over SAD 0~255, false if error bound above is exceeded
+		static bool testDifferenceTable(const double diffWeighting, const vector<float> &table);
+
+		// window functions specialized for a patch radius
+		struct KernelSet {
+			// specialized patch radius (0 for any radius)
+			int patchRadius;
+			// weighted average SAD of warped window, see evaluate()
+			double (*evaluate)(const FitnessWindow &win, bool &bounded);
+			// bilinear colors of window warped to image (patchSize*patchSize), false if out of image
+			bool (*warp)(const FitnessImage &img, const Matx33d &H, const Vec2d &pt, const int patchRadius, double *color);
+			// pixel-wised average SAD of window warped to visible images (patchSize*patchSize), false if out of image
+			bool (*sad)(const FitnessImage *img, const Matx33d *H, const int camNum, const Vec2d &pt, const int patchRadius, double *sad);
+		};
+		// select window functions of kernel (specialized for patch radius 7, 11 and 15)
+		static KernelSet select(const int kernel, const int patchRadius);
+
+		// weighted average SAD of warped window (DBL_MAX if window is out of image)
+		// bounded is set if evaluation stopped at win.bound and the result is a lower bound only
+		static double evaluate(const int kernel, const FitnessWindow &win, bool *bounded = NULL);
+	};
+};
+
+#endif
\ No newline at end of file
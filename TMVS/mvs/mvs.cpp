@@ -1,3 +1,4 @@
+#include <assert.h>
 #include "mvs.h"
 
 using namespace PAIS;
@@ -17,6 +18,21 @@ bool patchDistCompare(const PatchDist &p1, const PatchDist &p2) {
 	return (p1.dist < p2.dist);
 }
 
+// expansion patches of cells shared by expansion tasks
+struct ExpansionTasks {
+	const vector<const Patch*> *parents;
+	const vector<Vec3i> *cells;
+	vector<Patch*> *patches;
+	vector<int> *accept;
+	// patch id of first cell
+	int firstId;
+};
+
+// key of cell (camera index, cx, cy)
+static long long getCellKey(const Vec3i &cell) {
+	return ((long long) cell[0] << 42) | ((long long) (cell[1] & 0x1FFFFF) << 21) | (long long) (cell[2] & 0x1FFFFF);
+}
+
 /* constructor */
 
 MVS& MVS::getInstance(const MvsConfig &config) {
@@ -31,6 +47,7 @@ MVS& MVS::getInstance(const MvsConfig &config) {
 
 MVS::MVS(const MvsConfig &config) {
 	setConfig(config);
+	resetOptimizationStats();
 }
 
 MVS::~MVS(void) {
@@ -64,7 +81,34 @@ void MVS::setConfig(const MvsConfig &config) {
 	this->particleNum              = config.particleNum;
 	this->maxIteration             = config.maxIteration;
 	this->expansionStrategy        = config.expansionStrategy;
+	this->fitnessKernel            = FitnessKernel::resolve(config.fitnessKernel);
+	this->edgePrecision            = config.edgePrecision;
+	this->coarseStride             = max(1, config.coarseStride);
+	this->coarseIterationRatio     = min(max(config.coarseIterationRatio, 0.0), 1.0);
+	this->randomSeed               = config.randomSeed;
+	this->stagnationIteration      = max(0, config.stagnationIteration);
+	this->minImprovement           = max(0.0, config.minImprovement);
+	this->maxEvaluation            = max(0, config.maxEvaluation);
+	this->seedLocalRefinement      = config.seedLocalRefinement;
+	this->expansionLocalRefinement = config.expansionLocalRefinement;
+	this->localIteration           = max(0, config.localIteration);
+	this->localStepRatio           = config.localStepRatio;
+	this->optimizer                = config.optimizer;
+	this->swarmInitialization      = config.swarmInitialization;
+	this->warmStartNum             = max(0, config.warmStartNum);
+	this->batchPatchNum            = max(1, config.batchPatchNum);
+	this->expansionWaveNum         = max(1, config.expansionWaveNum);
+	this->expansionSchedulerEnable = config.expansionSchedulerEnable;
 	this->patchSize                = (patchRadius<<1)+1;
+	this->kernelSet                = FitnessKernel::select(fitnessKernel, patchRadius);
+
+	// rebuild difference weighting table
+	if (diffTable.empty() || diffTableWeighting != diffWeighting) {
+		FitnessKernel::getDifferenceTable(diffWeighting, diffTable);
+		diffTableWeighting = diffWeighting;
+		// self-test in debug build
+		assert( FitnessKernel::testDifferenceTable(diffWeighting, diffTable) );
+	}
 
 	printConfig();
 
@@ -87,10 +131,27 @@ bool MVS::initCellMaps() {
 }
 
 void MVS::initPriorityQueue() {
-	queue.clear();
-	map<int, Patch>::const_iterator it;
-	for (it = patches.begin(); it != patches.end(); ++it) {
-		queue.push_back(it->second.getId());
+	// queue order of expansion strategy
+	switch (expansionStrategy) {
+	default:
+	case EXPANSION_BEST_FIRST:
+		queue.reset(PatchQueue::ORDER_MIN_PRIORITY);
+		break;
+	case EXPANSION_WORST_FIRST:
+		queue.reset(PatchQueue::ORDER_MAX_PRIORITY);
+		break;
+	case EXPANSION_BREATH_FIRST:
+		queue.reset(PatchQueue::ORDER_FIFO);
+		break;
+	case EXPANSION_DEPTH_FIRST:
+		queue.reset(PatchQueue::ORDER_LIFO);
+		break;
+	}
+
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		const Patch &pth = patches.at(s);
+		queue.push(pth.getId(), pth.getPriority());
 	}
 }
 
@@ -116,10 +177,10 @@ void MVS::initPatchDistanceWeighting() {
 void MVS::setCellMaps() {
 	initCellMaps();
 
-	map<int, Patch>::iterator it;
 	int camNum, cx, cy;
-	for (it = patches.begin(); it != patches.end(); ++it) {
-		Patch &pth                     = it->second;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		Patch &pth                     = patches.at(s);
 		camNum                         = pth.getCameraNumber();
 		const vector<Vec2d> &imgPoints = pth.getImagePoints();
 		const vector<int> &camIdx      = pth.getCameraIndices();
@@ -135,10 +196,10 @@ void MVS::setCellMaps() {
 void MVS::reCentering() {
 	int count = 1;
 	int num   = (int) patches.size();
-	map<int, Patch>::iterator it;
-	for (it = patches.begin(); it != patches.end(); ++it, ++count) {
-		printf("\rre-triangulation: %d / %d", count, num);
-		Patch &pth = it->second;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		printf("\rre-triangulation: %d / %d", count++, num);
+		Patch &pth = patches.at(s);
 		pth.reCentering();
 	}
 	printf("\n");
@@ -151,6 +212,58 @@ void MVS::setNeighborRadius() {
 	printf("neighborRadius %f\n", neighborRadius);
 }
 
+void MVS::printCameraMemory() const {
+	const int camNum = (int) cameras.size();
+	if (camNum == 0) return;
+
+	size_t total = 0, totalEdge = 0;
+	for (int i = 0; i < camNum; ++i) {
+		size_t edge;
+		const size_t memory = cameras[i].getMemoryUsage(&edge);
+		total     += memory;
+		totalEdge += edge;
+		LogManager::log("camera %d memory\t%f MB\tedge\t%f MB", i, memory / 1048576.0, edge / 1048576.0);
+	}
+
+	printf("camera memory:\t%f MB per camera (edge %f MB), total %f MB\n", total / 1048576.0 / camNum, totalEdge / 1048576.0 / camNum, total / 1048576.0);
+}
+
+void MVS::resetOptimizationStats() {
+	optimizationNum        = 0;
+	optimizationIteration  = 0;
+	optimizationEvaluation = 0;
+	discardNum             = 0;
+	for (int i = 0; i < Optimizer::STOP_REASON_NUM; ++i) {
+		optimizationStop[i] = 0;
+	}
+}
+
+void MVS::addOptimizationStats(const int iteration, const int evaluation, const int stopReason) {
+	#pragma omp critical (optimizationStats)
+	{
+		optimizationNum++;
+		optimizationIteration  += iteration;
+		optimizationEvaluation += evaluation;
+		optimizationStop[stopReason]++;
+	}
+}
+
+void MVS::printOptimizationStats(const char *stage) const {
+	if (optimizationNum == 0) return;
+
+	printf("%s optimization:\t%d runs, %f iterations, %f evaluations per run\n", stage, optimizationNum, optimizationIteration / optimizationNum, optimizationEvaluation / optimizationNum);
+	LogManager::log("%s optimization\truns\t%d\tit\t%f\teval\t%f", stage, optimizationNum, optimizationIteration / optimizationNum, optimizationEvaluation / optimizationNum);
+	for (int i = 0; i < Optimizer::STOP_REASON_NUM; ++i) {
+		if (optimizationStop[i] == 0) continue;
+		printf("\tstop by %s:\t%d\n", Optimizer::getStopReasonName(i), optimizationStop[i]);
+		LogManager::log("%s optimization stop\t%s\t%d", stage, Optimizer::getStopReasonName(i), optimizationStop[i]);
+	}
+	if (discardNum > 0) {
+		printf("\tdiscarded after optimization:\t%d (%.1f%% of runs)\n", discardNum, 100.0 * discardNum / optimizationNum);
+		LogManager::log("%s optimization discard\t%d", stage, discardNum);
+	}
+}
+
 void MVS::clearDeletedPatches() {
 	deletedPatches.clear();
 }
@@ -159,16 +272,19 @@ void MVS::clearDeletedPatches() {
 
 void MVS::loadNVM(const char* fileName) {
 	FileLoader::loadNVM(fileName, *this);
+	printCameraMemory();
 	reCentering();
 }
 
 void MVS::loadNVM2(const char *fileName) {
 	FileLoader::loadNVM2(fileName, *this);
+	printCameraMemory();
 	reCentering();
 }
 
 void MVS::loadMVS(const char* fileName) {
 	FileLoader::loadMVS(fileName, *this);
+	printCameraMemory();
 }
 
 void MVS::writeMVS(const char* fileName) const {
@@ -200,22 +316,58 @@ void MVS::refineSeedPatches() {
 	}
 
 	setNeighborRadius();
+	resetOptimizationStats();
 
-	map<int, Patch>::iterator it;
-	for (it = patches.begin(); it != patches.end(); ) {
-		Patch &pth = it->second;
+	// seed patches in slot order
+	vector<Patch*> seeds;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		Patch &pth = patches.at(s);
 
 		// remove patch with few visible camera
 		if (pth.getCameraNumber() < minCamNum) {
-			it = deletePatch(pth);
+			deletePatch(pth);
 			continue;
 		}
 
-		pth.refine();
-		pth.removeInvisibleCamera();
+		seeds.push_back(&pth);
+	}
+	const int seedNum = (int) seeds.size();
+
+	// refine seeds concurrently, seeds only read cameras and config
+	if (batchPatchNum > 1) {
+		for (int begin = 0; begin < seedNum; begin += batchPatchNum) {
+			const int end = min(seedNum, begin + batchPatchNum);
+			Patch::refine(vector<Patch*>(seeds.begin() + begin, seeds.begin() + end));
+			printf("\rrefine seed patches: %d / %d", end, seedNum);
+		}
+	} else {
+		int count = 0;
+		#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < seedNum; ++i) {
+			seeds[i]->refine();
+			#pragma omp critical (seedProgress)
+			{
+				printf("\rrefine seed patches: %d / %d", ++count, seedNum);
+			}
+		}
+	}
+	printf("\n");
 
-		if ( !runtimeFiltering(pth) ) {
-			it = deletePatch(pth);
+	// accept or delete decisions
+	vector<int> accept(seedNum);
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < seedNum; ++i) {
+		seeds[i]->removeInvisibleCamera();
+		accept[i] = runtimeFiltering(*seeds[i]) ? 1 : 0;
+	}
+
+	// apply deletions and viewer events in slot order
+	for (int i = 0; i < seedNum; ++i) {
+		Patch &pth = *seeds[i];
+
+		if ( !accept[i] ) {
+			deletePatch(pth);
 			continue;
 		}
 
@@ -223,11 +375,10 @@ void MVS::refineSeedPatches() {
 		addPatchView(pth);
 
 		printf("ID: %d \t LOD: %d \t fit: %.2f \t pri: %.2f\n", pth.getId(), pth.getLOD(), pth.getFitness(), pth.getPriority());
-
-		++it;
 	}
 
 	setNeighborRadius();
+	printOptimizationStats("seed");
 }
 
 void MVS::expansionPatches() {
@@ -237,40 +388,86 @@ void MVS::expansionPatches() {
 	initPriorityQueue();
 	// set neighbor radius from bounding volume
 	setNeighborRadius();
+	resetOptimizationStats();
 
-	int pthId = getPatchIdFromQueue();
+	scheduler.resetUtilization();
+
+	// one parent at a time, or waves of parents expanded concurrently
+	const bool concurrent = (expansionWaveNum > 1 || batchPatchNum > 1 || expansionSchedulerEnable);
+
+	int pthId;
 	int saveTime = 0;
-	while ( !queue.empty() ) {
-		// get top priority seed patch
+	vector<Patch*> wave;
+	set<long long> footprint;
+	vector<Vec3i> neighborCells;
+	// get top priority seed patch (-1 if queue is empty)
+	while ( (pthId = getPatchIdFromQueue()) >= 0 ) {
 		Patch *pthP = getPatch(pthId);
 		// skip if not found
 		if (pthP == NULL) continue;
-		Patch &pth = *pthP;
 
-		pth.setExpanded();
+		if (concurrent) {
+			// wave of parents in queue order with disjoint neighbor cells
+			wave.clear();
+			footprint.clear();
+			while (true) {
+				Patch &pth = *pthP;
+				getNeighborCells(pth, neighborCells);
+
+				bool conflict = false;
+				for (int k = 0; k < (int) neighborCells.size(); ++k) {
+					if (footprint.count(getCellKey(neighborCells[k])) > 0) {
+						conflict = true;
+						break;
+					}
+				}
+				// expand conflicting parent in next wave
+				if (conflict) {
+					queue.unpop(pth.getId(), pth.getPriority());
+					break;
+				}
 
-		printf("parent: fit: %f \t pri: %f \t camNum: %d\n", pth.getFitness(), pth.getPriority(), pth.getCameraNumber());
-		
-		// skip
-		if ( !runtimeFiltering(pth) ) {
-			printf("Top priority patch deleted\n");
-			deletePatch(pth);
-			continue;
-		}
+				for (int k = 0; k < (int) neighborCells.size(); ++k) {
+					footprint.insert(getCellKey(neighborCells[k]));
+				}
+				pth.setExpanded();
+				wave.push_back(&pth);
+
+				if ((int) wave.size() >= expansionWaveNum) break;
+				if ((pthId = getPatchIdFromQueue()) < 0) break;
+				pthP = getPatch(pthId);
+			}
 
-		// expand patch
-		expandNeighborCell(pth);
+			expandWave(wave);
+		} else {
+			Patch &pth = *pthP;
+
+			pth.setExpanded();
+
+			printf("parent: fit: %f \t pri: %f \t camNum: %d\n", pth.getFitness(), pth.getPriority(), pth.getCameraNumber());
+			
+			// skip
+			if ( !runtimeFiltering(pth) ) {
+				printf("Top priority patch deleted\n");
+				deletePatch(pth);
+				continue;
+			}
+
+			// expand patch
+			expandNeighborCell(pth);
+		}
 		
 		if (patches.size() / 500 > saveTime) {
 			saveTime++;
 			writeMVS("auto_save.mvs");
 		}
-
-		// get next seed patch id
-		pthId = getPatchIdFromQueue();
 	}
 
 	setNeighborRadius();
+	printOptimizationStats("expansion");
+	if (concurrent && expansionSchedulerEnable) {
+		scheduler.printUtilization("expansion");
+	}
 }
 
 /* filtering */
@@ -401,11 +598,11 @@ void MVS::visibilityFiltering() {
 		setCellMaps();
 	}
 
-	map<int, Patch>::iterator it;
 	int camNum, cx, cy;
 	double depth, neighborDepth;
-	for (it = patches.begin(); it != patches.end(); ) {
-		Patch &pth = it->second;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		Patch &pth = patches.at(s);
 		camNum = pth.getCameraNumber();
 		const vector<Vec2d> &imgPoints = pth.getImagePoints();
 		const vector<int> &camIdx = pth.getCameraIndices();
@@ -436,11 +633,8 @@ void MVS::visibilityFiltering() {
 
 		// drop patch if few visible camera
 		if (visibleCount < minCamNum) {
-			it = deletePatch(pth);
-			continue;
+			deletePatch(pth);
 		}
-
-		++it;
 	}
 }
 
@@ -452,8 +646,9 @@ void MVS::neighborPatchFiltering(const double neighborRatio) {
 
 	// copy patch id
 	vector<int> patchIds;
-	for (map<int, Patch>::const_iterator it = patches.begin(); it != patches.end(); ++it) {
-		const Patch &pth = it->second; // current patch
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		const Patch &pth = patches.at(s); // current patch
 		patchIds.push_back(pth.getId());
 	}
 
@@ -474,8 +669,9 @@ void MVS::neighborPatchFiltering(const double neighborRatio) {
 		const Patch &pth = *pthP;
 
 		vector<PatchDist> dist;              // dist container
-		for (map<int, Patch>::const_iterator itN = patches.begin(); itN != patches.end(); ++itN) {
-			const Patch &pthN = itN->second; // current neighbor patch
+		for (int s = 0; s < patches.getSlotNum(); ++s) {
+			if ( !patches.isUsed(s) ) continue;
+			const Patch &pthN = patches.at(s); // current neighbor patch
 
 			// skip self
 			if (pthN.getId() == pth.getId()) continue;
@@ -525,18 +721,18 @@ void MVS::neighborPatchFiltering(const double neighborRatio) {
 
 /* process */
 
-void MVS::expandNeighborCell(const Patch &pth) {
+void MVS::getNeighborCells(const Patch &pth, vector<Vec3i> &cells) const {
 	const int camNum               = pth.getCameraNumber();
 	const vector<int> &camIdx      = pth.getCameraIndices();
 	const vector<Vec2d> &imgPoints = pth.getImagePoints();
 
+	cells.clear();
+
 	int cx, cy;
 	for (int i = 0; i < camNum; ++i) {
 		// only expansion visible image cell
 		//if (camIdx[i] != pth.getReferenceCameraIndex()) continue;
 
-		// camera
-		const Camera &cam = cameras[camIdx[i]];
 		// cell map
 		const CellMap &map = cellMaps[camIdx[i]];
 
@@ -551,17 +747,28 @@ void MVS::expandNeighborCell(const Patch &pth) {
 		for (int j = 0; j < 4; ++j) {
 			// skip out of map
 			if ( !map.inMap(nx[j], ny[j]) ) continue;
-
-			// skip neighbor cell with exist neighbor patch or discontinuous
-			const vector<int> &cell = map.getCell(nx[j], ny[j]);
-			if ( skipNeighborCell(cell, pth) ) continue;
-
-			// expand neighbor cell (create expansion patch)
-			expandCell(cam, pth, nx[j], ny[j]);
+			cells.push_back(Vec3i(camIdx[i], nx[j], ny[j]));
 		} // end of neighbor cell
 	} // end of cameras
 }
 
+void MVS::expandNeighborCell(const Patch &pth) {
+	vector<Vec3i> cells;
+	getNeighborCells(pth, cells);
+
+	const int cellNum = (int) cells.size();
+	for (int k = 0; k < cellNum; ++k) {
+		const Vec3i &c = cells[k];
+
+		// skip neighbor cell with exist neighbor patch or discontinuous
+		const vector<int> &cell = cellMaps[c[0]].getCell(c[1], c[2]);
+		if ( skipNeighborCell(cell, pth) ) continue;
+
+		// expand neighbor cell (create expansion patch)
+		expandCell(cameras[c[0]], pth, c[1], c[2]);
+	}
+}
+
 void MVS::expandCell(const PAIS::Camera &cam, const Patch &parent, const int cx, const int cy) {
 	// get expansion patch center
 	Vec3d center;
@@ -575,18 +782,143 @@ void MVS::expandCell(const PAIS::Camera &cam, const Patch &parent, const int cx,
 	insertPatch(expPatch);
 }
 
+void MVS::expandCells(const vector<const Patch*> &parents, const vector<Vec3i> &cells) {
+	const int num = (int) cells.size();
+	if (num == 0) return;
+
+	vector<Patch*> expPatches(num, (Patch *) NULL);
+	vector<int>    accept(num, 1);
+
+	if (!expansionSchedulerEnable) {
+		// get expansion patches (patch id in cell order)
+		for (int k = 0; k < num; ++k) {
+			Vec3d center;
+			getExpansionPatchCenter(cameras[cells[k][0]], *parents[k], cells[k][1], cells[k][2], center);
+			expPatches[k] = new Patch(center, *parents[k]);
+		}
+
+		// refine in lockstep batches
+		for (int begin = 0; begin < num; begin += batchPatchNum) {
+			const int end = min(num, begin + batchPatchNum);
+			Patch::refine(vector<Patch*>(expPatches.begin() + begin, expPatches.begin() + end));
+		}
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < num; ++k) {
+			expPatches[k]->removeInvisibleCamera();
+		}
+	} else {
+		// create, refine and filter expansion patches as work-stealing tasks (patch id in cell order)
+		ExpansionTasks tasks;
+		tasks.parents = &parents;
+		tasks.cells   = &cells;
+		tasks.patches = &expPatches;
+		tasks.accept  = &accept;
+		tasks.firstId = AbstractPatch::reserveId(num);
+
+		// cells of better parents first
+		for (int k = 0; k < num; ++k) {
+			scheduler.push(createExpansionTask, k, &tasks, k);
+		}
+		scheduler.run();
+	}
+
+	// commit in cell order, cell may be taken by patch inserted before
+	for (int k = 0; k < num; ++k) {
+		const Vec3i &c = cells[k];
+		if (accept[k]) {
+			if ( skipNeighborCell(cellMaps[c[0]].getCell(c[1], c[2]), *parents[k]) ) {
+				discardNum++;
+			} else if (expansionSchedulerEnable) {
+				// runtime filtering is done by filter task
+				addPatch(*expPatches[k]);
+			} else {
+				insertPatch(*expPatches[k]);
+			}
+		}
+		delete expPatches[k];
+	}
+}
+
+void MVS::createExpansionTask(const int idx, void *obj) {
+	ExpansionTasks &tasks = *((ExpansionTasks *) obj);
+	MVS &mvs = MVS::getInstance();
+	const Patch &parent = *(*tasks.parents)[idx];
+	const Vec3i &c      = (*tasks.cells)[idx];
+
+	// get expansion patch
+	Vec3d center;
+	mvs.getExpansionPatchCenter(mvs.cameras[c[0]], parent, c[1], c[2], center);
+	(*tasks.patches)[idx] = new Patch(center, parent, tasks.firstId + idx);
+
+	mvs.scheduler.spawn(refineExpansionTask, idx, obj);
+}
+
+void MVS::refineExpansionTask(const int idx, void *obj) {
+	ExpansionTasks &tasks = *((ExpansionTasks *) obj);
+	MVS &mvs = MVS::getInstance();
+
+	(*tasks.patches)[idx]->refine();
+
+	mvs.scheduler.spawn(filterExpansionTask, idx, obj);
+}
+
+void MVS::filterExpansionTask(const int idx, void *obj) {
+	ExpansionTasks &tasks = *((ExpansionTasks *) obj);
+	const MVS &mvs = MVS::getInstance();
+	Patch &pth = *(*tasks.patches)[idx];
+
+	// runtime filtering only depends on patch, accepted patches skip it at commit
+	pth.removeInvisibleCamera();
+	(*tasks.accept)[idx] = mvs.runtimeFiltering(pth) ? 1 : 0;
+}
+
+void MVS::expandWave(const vector<Patch*> &wave) {
+	vector<const Patch*> parents;
+	vector<Vec3i> cells;
+	vector<Vec3i> neighborCells;
+
+	for (int i = 0; i < (int) wave.size(); ++i) {
+		Patch &pth = *wave[i];
+
+		printf("parent: fit: %f \t pri: %f \t camNum: %d\n", pth.getFitness(), pth.getPriority(), pth.getCameraNumber());
+
+		// skip
+		if ( !runtimeFiltering(pth) ) {
+			printf("Top priority patch deleted\n");
+			deletePatch(pth);
+			continue;
+		}
+
+		// candidate cells, checked again at commit
+		getNeighborCells(pth, neighborCells);
+		for (int k = 0; k < (int) neighborCells.size(); ++k) {
+			const Vec3i &c = neighborCells[k];
+			if ( skipNeighborCell(cellMaps[c[0]].getCell(c[1], c[2]), pth) ) continue;
+			parents.push_back(&pth);
+			cells.push_back(c);
+		}
+	}
+
+	expandCells(parents, cells);
+}
+
 void MVS::insertPatch(const Patch &pth) {
 	if ( !runtimeFiltering(pth) ) return;
 
+	addPatch(pth);
+}
+
+void MVS::addPatch(const Patch &pth) {
 	const int camNum = pth.getCameraNumber();
 	const vector<Vec2d> &imgPoints = pth.getImagePoints();
 	const vector<int>   &camIdx    = pth.getCameraIndices();
 	int cx, cy;
 
 	// insert into patches container
-	patches.insert(pair<int, Patch>(pth.getId(), pth));
+	patches.insert(pth.getId(), pth);
 	// insert into priority queue
-	queue.push_back(pth.getId());
+	queue.push(pth.getId(), pth.getPriority());
 	
 	// insert into cell maps
 	for (int i = 0; i < camNum; ++i) {
@@ -599,17 +931,17 @@ void MVS::insertPatch(const Patch &pth) {
 	addPatchView(pth);
 }
 
-map<int, Patch>::iterator MVS::deletePatch(Patch &pth) {
+bool MVS::deletePatch(Patch &pth) {
 	return deletePatch(pth.getId());
 }
 
-map<int, Patch>::iterator MVS::deletePatch(const int id) {
-	map<int, Patch>::iterator it = patches.find(id);
-	if (it == patches.end()) return patches.end();
+bool MVS::deletePatch(const int id) {
+	const Patch *pthP = patches.find(id);
+	if (pthP == NULL) return false;
 
 	// remove from cell maps
 	if(!cellMaps.empty()) {
-		const Patch &pth = it->second;
+		const Patch &pth = *pthP;
 		const int camNum = pth.getCameraNumber();
 		const vector<int> &camIdx = pth.getCameraIndices();
 		const vector<Vec2d> &imgPoints = pth.getImagePoints();
@@ -622,28 +954,25 @@ map<int, Patch>::iterator MVS::deletePatch(const int id) {
 		}
 	}
 
+	// remove from priority queue
+	queue.remove(id);
+
 	// push to deleted patches container
-	deletedPatches.push_back(it->second);
+	deletedPatches.push_back(*pthP);
 
-	return patches.erase(it);
+	return patches.erase(id);
 }
 
-int MVS::getPatchIdFromQueue() const {
+int MVS::getPatchIdFromQueue() {
 	int id = -1;
 
-	switch (expansionStrategy) {
-	default:
-	case EXPANSION_BEST_FIRST:
-		id = getTopPriorityPatchId();
-		break;
-	case EXPANSION_WORST_FIRST:
-		id = getLastPriorityPatchId();
-		break;
-	case EXPANSION_BREATH_FIRST:
-		id = getBreathFirstPatchId();
-		break;
-	case EXPANSION_DEPTH_FIRST:
-		id = getDepthFirstPatchId();
+	// skip deleted and expanded patches (lazy deletion)
+	while ( !queue.empty() ) {
+		const int topId = queue.pop();
+		const Patch *pthP = getPatch(topId);
+		if (pthP == NULL) continue;
+		if (pthP->isExpanded()) continue;
+		id = topId;
 		break;
 	}
 
@@ -652,140 +981,6 @@ int MVS::getPatchIdFromQueue() const {
 	return id;
 }
 
-int MVS::getTopPriorityPatchId() const {
-	vector<int>::iterator it;
-	vector<int>::iterator topIt = queue.end();
-	double topPriority = DBL_MAX;
-
-	for (it = queue.begin(); it != queue.end();) { 
-		const Patch *pthP = getPatch(*it);
-		if (pthP == NULL) {
-			it = queue.erase(it);
-			continue;
-		}
-		const Patch &pth = *pthP;
-
-		// skip expanded
-		if ( pth.isExpanded() ) {
-			it = queue.erase(it);
-			continue;
-		}
-
-		// update top priority
-		if (pth.getPriority() < topPriority) {
-			topPriority = pth.getPriority();
-			topIt       = it;
-		}
-
-		++it;
-	}
-
-	int topId = -1;
-
-	// delete top id from queue
-	if (topIt != queue.end()) {
-		topId = *topIt;
-		queue.erase(topIt);
-	}
-
-	return topId;
-}
-
-int MVS::getLastPriorityPatchId() const {
-	vector<int>::iterator it;
-	vector<int>::iterator topIt = queue.end();
-	double topPriority = -DBL_MAX;
-
-	for (it = queue.begin(); it != queue.end();) { 
-		const Patch *pthP = getPatch(*it);
-		if (pthP == NULL) {
-			it = queue.erase(it);
-			continue;
-		}
-		const Patch &pth = *pthP;
-
-		// skip expanded
-		if ( pth.isExpanded() ) {
-			it = queue.erase(it);
-			continue;
-		}
-
-		// update top priority
-		if (pth.getPriority() > topPriority) {
-			topPriority = pth.getPriority();
-			topIt       = it;
-		}
-
-		++it;
-	}
-
-	int topId = -1;
-
-	// delete top id from queue
-	if (topIt != queue.end()) {
-		topId = *topIt;
-		queue.erase(topIt);
-	}
-
-	return topId;
-}
-
-int MVS::getBreathFirstPatchId() const {
-	vector<int>::iterator it;
-	int topId = -1;
-
-	for (it = queue.begin(); it != queue.end();) {
-		const Patch *pthP = getPatch(*it);
-		if (pthP == NULL) {
-			it = queue.erase(it);
-			continue;
-		}
-		const Patch &pth = *pthP;
-
-		// skip expanded
-		if ( pth.isExpanded() ) {
-			it = queue.erase(it);
-			continue;
-		}
-
-		topId = *it;
-		break;
-	}
-
-	queue.erase(it);
-
-	return topId;
-}
-
-int MVS::getDepthFirstPatchId() const {
-	vector<int>::iterator it;
-	int topId = -1;
-
-	for (it = queue.end()-1; it != queue.begin();) {
-		const Patch *pthP = getPatch(*it);
-		if (pthP == NULL) {
-			queue.erase(it);
-			it = queue.end()-1;
-			continue;
-		}
-		const Patch &pth = *pthP;
-
-		// skip expanded
-		if ( pth.isExpanded() ) {
-			queue.erase(it);
-			it = queue.end()-1;
-			continue;
-		}
-
-		topId = *it;
-		break;
-	}
-
-	queue.erase(it);
-
-	return topId;
-}
-
 /* const function */
 
 bool MVS::skipNeighborCell(const vector<int> &cell, const Patch &refPth) const {
@@ -899,6 +1094,17 @@ bool MVS::runtimeFiltering(const Patch &pth) const {
 	return true;
 }
 
+const char* MVS::getLocalRefinementName(const int localRefinement) {
+	switch (localRefinement) {
+	case LOCAL_AFTER_PSO:
+		return "Nelder-Mead after PSO";
+	case LOCAL_ONLY:
+		return "Nelder-Mead only";
+	default:
+		return "none";
+	}
+}
+
 void MVS::printConfig() const {
 	printf("MVS config\n");
 	printf("-------------------------------\n");
@@ -953,24 +1159,65 @@ void MVS::printConfig() const {
 		printf("expansion strategy:\tDepth first\n");
 		break;
 	}
+	printf("fitness kernel:\t%s\n", FitnessKernel::getName(fitnessKernel));
+	switch (edgePrecision) {
+	default:
+	case Camera::EDGE_DOUBLE:
+		printf("edge precision:\tdouble\n");
+		break;
+	case Camera::EDGE_FLOAT:
+		printf("edge precision:\tfloat\n");
+		break;
+	case Camera::EDGE_UINT8:
+		printf("edge precision:\tuint8\n");
+		break;
+	}
+	printf("coarse stride:\t%d\n", coarseStride);
+	printf("coarse iteration ratio:\t%f\n", coarseIterationRatio);
+	printf("random seed:\t%d\n", randomSeed);
+	printf("stagnation iteration:\t%d\n", stagnationIteration);
+	printf("minimum improvement:\t%f\n", minImprovement);
+	printf("maximum evaluation:\t%d\n", maxEvaluation);
+	printf("seed local refinement:\t%s\n", getLocalRefinementName(seedLocalRefinement));
+	printf("expansion local refinement:\t%s\n", getLocalRefinementName(expansionLocalRefinement));
+	printf("local iteration:\t%d\n", localIteration);
+	printf("local step ratio:\t%f\n", localStepRatio);
+	switch (optimizer) {
+	default:
+	case OPTIMIZER_PSO:
+		printf("optimizer:\tPSO\n");
+		break;
+	case OPTIMIZER_CMAES:
+		printf("optimizer:\tCMA-ES\n");
+		break;
+	}
+	switch (swarmInitialization) {
+	default:
+	case Optimizer::INIT_UNIFORM:
+		printf("swarm initialization:\tuniform\n");
+		break;
+	case Optimizer::INIT_HALTON:
+		printf("swarm initialization:\tHalton\n");
+		break;
+	}
+	printf("warm start particle number:\t%d\n", warmStartNum);
+	printf("batch patch number:\t%d\n", batchPatchNum);
+	printf("expansion wave number:\t%d\n", expansionWaveNum);
+	if (expansionSchedulerEnable) {
+		printf("expansion scheduler enable:\tenable\n");
+	} else {
+		printf("expansion scheduler enable:\tdisable\n");
+	}
 	printf("-------------------------------\n");
 }
 
 /* getter */
 const Patch* MVS::getPatch(const int id) const {
-	if ( patches.find(id) != patches.end() ) {
-		return &patches.at(id);
-	} else {
-		return NULL;
-	}
+	return patches.find(id);
 }
 
 Patch* MVS::getPatch(const int id) {
-	if ( patches.find(id) != patches.end() ) {
-		return &patches.at(id);
-	} else {
-		return NULL;
-	}
+	return patches.find(id);
 }
 
 double MVS::getBoundingVolume(Vec3d *minPtr, Vec3d *maxPtr) const {
@@ -982,10 +1229,9 @@ double MVS::getBoundingVolume(Vec3d *minPtr, Vec3d *maxPtr) const {
 	maxP[0] = -DBL_MAX;
 	maxP[1] = -DBL_MAX;
 	maxP[2] = -DBL_MAX;
-	map<int, Patch>::const_iterator it;
-
-	for (it = patches.begin(); it != patches.end(); ++it) {
-		const Patch &pth = it->second;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		const Patch &pth = patches.at(s);
 		const Vec3d &center = pth.getCenter();
 		for (int i = 0; i < 3; ++i) {
 			if (center[i] < minP[i]) minP[i] = center[i];
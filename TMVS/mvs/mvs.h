@@ -2,11 +2,17 @@
 #define __PAIS_MVS_H__
 
 #include <math.h>
+#include <set>
 #define _USE_MATH_DEFINES
 
 #include "../io/fileloader.h"
 #include "../io/filewriter.h"
 #include "cellmap.h"
+#include "patchqueue.h"
+#include "slotmap.h"
+#include "taskscheduler.h"
+#include "fitnesskernel.h"
+#include "../pso/optimizer.h"
 
 // trigger viewer event
 extern void addPatchView(const Patch &pth);
@@ -69,6 +75,39 @@ namespace PAIS {
 		int maxIteration;
 		// expansion strategy (best, worst, breath, depth)
 		int expansionStrategy;
+		// fitness kernel (scalar, SSE4, AVX2, auto)
+		int fitnessKernel;
+		// edge pyramid storage precision (double, float, uint8)
+		int edgePrecision;
+		// window sampling stride of coarse PSO iterations (1 for full window)
+		int coarseStride;
+		// ratio of PSO iterations evaluated by coarse window
+		double coarseIterationRatio;
+		// global run seed of PSO random streams, combined with patch id (negative for time based seed)
+		int randomSeed;
+		// PSO stopping rules (0 disables each): iterations without gBest improvement,
+		// minimum relative gBest improvement over those iterations and fitness evaluation budget
+		int stagnationIteration;
+		double minImprovement;
+		int maxEvaluation;
+		// local refinement of seed and expansion patches (none, after PSO, instead of PSO)
+		int seedLocalRefinement;
+		int expansionLocalRefinement;
+		// Nelder-Mead iterations and initial simplex step (ratio of search range)
+		int localIteration;
+		double localStepRatio;
+		// patch optimizer (PSO, CMA-ES)
+		int optimizer;
+		// initial swarm sampling (uniform random, randomly shifted Halton)
+		int swarmInitialization;
+		// best pBest particles of final swarm inherited by expansion patches (0 disables)
+		int warmStartNum;
+		// maximum patches refined together by lockstep PSO (1 for one patch at a time)
+		int batchPatchNum;
+		// maximum parent patches expanded concurrently per wave (1 for one parent at a time)
+		int expansionWaveNum;
+		// expand waves by work-stealing tasks (create, refine, filter each patch) instead of lockstep batches
+		bool expansionSchedulerEnable;
 	};
 
 	class MVS : private MvsConfig {
@@ -83,15 +122,29 @@ namespace PAIS {
 		// camera container
 		vector<Camera>  cameras;
 		// patch container (id, patch)
-		map<int, Patch> patches;
+		SlotMap<Patch> patches;
 		// cell map container
 		vector<CellMap> cellMaps;
 		// pixel-wised distance weighting of patch
 		Mat_<double> patchDistWeight;
+		// window functions of fitness kernel and patch radius
+		FitnessKernel::KernelSet kernelSet;
+		// adaptive difference weighting table and its difference weighting
+		vector<float> diffTable;
+		double diffTableWeighting;
 		// priority queue (patch id)
-		mutable vector<int> queue;
+		PatchQueue queue;
 		// deleted patch container
 		vector<Patch> deletedPatches;
+		// work-stealing scheduler of expansion tasks
+		TaskScheduler scheduler;
+		// PSO run counters of current stage (runs, iterations, evaluations, runs of each stop reason)
+		int    optimizationNum;
+		double optimizationIteration;
+		double optimizationEvaluation;
+		int    optimizationStop[Optimizer::STOP_REASON_NUM];
+		// optimized expansion patches discarded at commit since cell was taken by patch inserted before
+		int    discardNum;
 		
 		/* getter */
 		// get patch by id
@@ -114,24 +167,27 @@ namespace PAIS {
 		/******************
 			expansion
 		*******************/
+		// one ring neighbor cells (camera index, cx, cy) of patch in all visible images
+		void getNeighborCells(const Patch &pth, vector<Vec3i> &cells) const;
 		// expansion one ring neighbor cells in all visible images (optional: only reference image)
 		void expandNeighborCell(const Patch &pth);
 		// expansion cell
 		void expandCell(const Camera &cam, const Patch &parent, const int cx, const int cy);
+		// refine expansion patches of cells (camera index, cx, cy) and parents concurrently,
+		// in lockstep batches or as work-stealing tasks, commit in cell order after re-checking cells
+		void expandCells(const vector<const Patch*> &parents, const vector<Vec3i> &cells);
+		// expand wave of parents with disjoint neighbor cells together
+		void expandWave(const vector<Patch*> &wave);
+		// expansion tasks of cell idx (create expansion patch, refine, runtime filtering)
+		static void createExpansionTask(const int idx, void *obj);
+		static void refineExpansionTask(const int idx, void *obj);
+		static void filterExpansionTask(const int idx, void *obj);
 
 		/*****************
 			get patch id from queue
 		******************/
-		// get patch id from queue (entry function)
-		int getPatchIdFromQueue() const;
-		// get top priority patch id from queue to expansion (best first)
-		int getTopPriorityPatchId() const;
-		// get last priority patch id from queue to expansion (worst first)
-		int getLastPriorityPatchId() const;
-		// get next patch id from queue to expansion (breath first)
-		int getBreathFirstPatchId() const;
-		// get next patch id from queue to expansion (depth first)
-		int getDepthFirstPatchId() const;
+		// get next patch id from queue in order of expansion strategy (-1 if queue is empty)
+		int getPatchIdFromQueue();
 
 		// check neighbor patches in cell
 		bool skipNeighborCell(const vector<int> &cell, const Patch &refPth) const;
@@ -145,11 +201,21 @@ namespace PAIS {
 		******************/
 		// insert new patch in patch pool and queue
 		void insertPatch(const Patch &pth);
-		// delete patch and return next patch iterator and push deleted patch into deleted patches container
-		map<int, Patch>::iterator deletePatch(Patch &pth);
-		map<int, Patch>::iterator deletePatch(const int id);
+		// insert new patch which passed runtime filtering
+		void addPatch(const Patch &pth);
+		// delete patch and push deleted patch into deleted patches container (false if not found)
+		bool deletePatch(Patch &pth);
+		bool deletePatch(const int id);
 		// set neighbor radius from bounding volume
 		void setNeighborRadius();
+		// print memory usage of loaded cameras
+		void printCameraMemory() const;
+		// clear PSO run counters
+		void resetOptimizationStats();
+		// add counters of finished PSO run
+		void addOptimizationStats(const int iteration, const int evaluation, const int stopReason);
+		// print and log PSO run counters of stage
+		void printOptimizationStats(const char *stage) const;
 
 	public:
 		friend class FileWriter;
@@ -164,6 +230,15 @@ namespace PAIS {
 		static const int EXPANSION_BREATH_FIRST = 0x02;
 		static const int EXPANSION_DEPTH_FIRST  = 0x03;
 
+		// patch optimizer
+		static const int OPTIMIZER_PSO   = 0x00;
+		static const int OPTIMIZER_CMAES = 0x01;
+
+		// local refinement
+		static const int LOCAL_NONE      = 0x00;
+		static const int LOCAL_AFTER_PSO = 0x01;
+		static const int LOCAL_ONLY      = 0x02;
+
 		/*****************
 			instance getter
 		******************/
@@ -197,13 +272,17 @@ namespace PAIS {
 		// get camera by its index
 		const Camera& getCamera(const int idx)          const { return cameras[idx];    }
 		// get system patches
-		const map<int, Patch>& getPatches()             const { return patches;         }
+		const SlotMap<Patch>& getPatches()              const { return patches;         }
 		// get deleted patches
 		const vector<Patch>& getDeletedPatches()        const { return deletedPatches;  }
 		// get system cell maps
 		const vector<CellMap>& getCellMaps()            const { return cellMaps;        }
 		// get pre-computed patch distance matrix (same size of patch size)
 		const Mat_<double>& getPatchDistanceWeighting() const { return patchDistWeight; }
+		// get window functions selected by fitness kernel and patch radius
+		const FitnessKernel::KernelSet& getKernelSet()  const { return kernelSet;       }
+		// get adaptive difference weighting table
+		const vector<float>& getDifferenceTable()       const { return diffTable;       }
 		// get patch by id
 		const Patch* getPatch(const int id) const;
 		
@@ -216,12 +295,19 @@ namespace PAIS {
 		double getDistanceWeight()     const { return distWeighting;      }
 		double getGradientWeight()     const { return gradientWeighting;  }
 		int    getMinLOD()             const { return minLOD;             }
+		int    getFitnessKernel()      const { return fitnessKernel;      }
+		int    getEdgePrecision()      const { return edgePrecision;      }
+		int    getCoarseStride()       const { return coarseStride;       }
+		double getCoarseIterationRatio() const { return coarseIterationRatio; }
+		int    getRandomSeed()         const { return randomSeed;         }
 		double getReduceNormalRange()  const { return reduceNormalRange;  }
 		double getBoundingVolume(Vec3d *minPtr, Vec3d *maxPtr) const;
 		bool isAdaptiveDistanceEnable()   const { return adaptiveDistanceEnable;   }
 		bool isAdaptiveDifferenceEnable() const { return adaptiveDifferenceEnable; }
 		bool isAdaptiveGradientEnable()   const { return adaptiveGradientEnable;   }
 
+		// get local refinement name
+		static const char* getLocalRefinementName(const int localRefinement);
 		// print config information
 		void printConfig() const;
 
@@ -1,4 +1,5 @@
 #include "patch.h"
+#include "fitnesscontext.h"
 
 using namespace PAIS;
 
@@ -23,6 +24,11 @@ bool Patch::isNeighbor(const Patch &pth1, const Patch &pth2) {
 }
 
 /* constructor */
+Patch::Patch(void) : AbstractPatch(ID_NONE) {
+	this->type = TYPE_SEED;
+	this->drop = true;
+}
+
 Patch::Patch(const Vec3d &center, const Vec3b &color, const vector<int> &camIdx, const vector<Vec2d> &imgPoint, const int id) : AbstractPatch(id) {
 	this->type     = TYPE_SEED;
 	this->center   = center;
@@ -38,6 +44,9 @@ Patch::Patch(const Vec3d &center, const Patch &parent, const int id) : AbstractP
     this->center    = center;
 	this->camIdx    = parent.getCameraIndices();
 	this->drop      = false;
+	this->swarmCenters = parent.swarmCenters;
+	this->swarmNormals = parent.swarmNormals;
+	this->swarmSpread  = parent.swarmSpread;
 	setNormal(parent.getNormal());
 	expandVisibleCamera();
 }
@@ -112,6 +121,89 @@ void Patch::reCentering() {
 }
 
 void Patch::refine() {
+	bool optimization = beginRefine();
+	while (optimization) {
+		// do pso optimization (update center and normal)
+		psoOptimization();
+		optimization = endOptimization();
+	}
+}
+
+void Patch::refine(const vector<Patch*> &pths) {
+	const MVS &mvs = MVS::getInstance();
+	const int pthNum = (int) pths.size();
+
+	// lockstep runs are PSO only
+	if (mvs.optimizer != MVS::OPTIMIZER_PSO) {
+		for (int i = 0; i < pthNum; ++i) {
+			pths[i]->refine();
+		}
+		return;
+	}
+
+	vector<int> optimization(pthNum);
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < pthNum; ++i) {
+		optimization[i] = pths[i]->beginRefine() ? 1 : 0;
+	}
+
+	BatchSolver &batch = BatchSolver::getThreadSolver();
+	vector<int> members;
+	vector<FitnessContext*> contexts;
+	vector<int> solverIdx;
+	while (true) {
+		// patches waiting for (re-)optimization
+		members.clear();
+		for (int i = 0; i < pthNum; ++i) {
+			if (optimization[i]) members.push_back(i);
+		}
+		if (members.empty()) break;
+
+		const int memberNum = (int) members.size();
+		const clock_t start_t = clock();
+
+		// reference windows of patches
+		contexts.assign(memberNum, (FitnessContext *) NULL);
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < memberNum; ++k) {
+			contexts[k] = new FitnessContext(*pths[members[k]]);
+		}
+
+		// solver of each patch with global search
+		solverIdx.assign(memberNum, -1);
+		int solverNum = 0;
+		for (int k = 0; k < memberNum; ++k) {
+			const Patch &pth = *pths[members[k]];
+			if ( !contexts[k]->isInside() ) continue;
+			if (pth.getLocalRefinement() == MVS::LOCAL_ONLY) continue;
+			solverIdx[k] = solverNum++;
+		}
+		batch.setMemberNum(solverNum, 3);
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < memberNum; ++k) {
+			if (solverIdx[k] < 0) continue;
+			pths[members[k]]->initOptimization(batch.getSolver(solverIdx[k]), *contexts[k]);
+		}
+
+		batch.run(true);
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < memberNum; ++k) {
+			Patch &pth = *pths[members[k]];
+			if ( !contexts[k]->isInside() ) {
+				pth.fitness = DBL_MAX;
+			} else {
+				Optimizer *solver = (solverIdx[k] < 0) ? NULL : &batch.getSolver(solverIdx[k]);
+				pth.setOptimizationResult(solver, *contexts[k], start_t);
+			}
+			optimization[members[k]] = pth.endOptimization() ? 1 : 0;
+			delete contexts[k];
+		}
+	}
+}
+
+bool Patch::beginRefine() {
 	const MVS &mvs = MVS::getInstance();
 
 	// skip few cameras
@@ -119,7 +211,7 @@ void Patch::refine() {
 		fitness  = DBL_MAX;
 		priority = DBL_MAX;
 		drop = true;
-		return;
+		return false;
 	}
 
 	setReferenceCameraIndex();
@@ -127,52 +219,58 @@ void Patch::refine() {
 	setDepthRange();
 	setLOD();
 
-	if (drop) return;
+	if (drop) return false;
 
-	int beforeRefCamIdx = refCamIdx;
-	int afterRefCamIdx  = -1;
-	int beforeCamNum    = getCameraNumber();
-	int afterCamNum     = -1;
-	int count           = 0; // optimization counter
-	int totalCamNum     = beforeCamNum;
+	refineCount  = 0; // optimization counter
+	refineCamNum = getCameraNumber();
 
-	// re-optimization when reference camera index or visible cameras are changed
-	while ( (beforeRefCamIdx != afterRefCamIdx || beforeCamNum != afterCamNum) && count++ <= totalCamNum ) {
+	return beginOptimization();
+}
 
-		if (getCameraNumber() < mvs.minCamNum) {
-			fitness  = DBL_MAX;
-			priority = DBL_MAX;
-			drop = true;
-			return;
-		}
+bool Patch::beginOptimization() {
+	const MVS &mvs = MVS::getInstance();
 
-		beforeRefCamIdx = refCamIdx;
-		beforeCamNum    = getCameraNumber();
+	if (getCameraNumber() < mvs.minCamNum) {
+		fitness  = DBL_MAX;
+		priority = DBL_MAX;
+		drop = true;
+		return false;
+	}
 
-		// do pso optimization (update center and normal)
-		psoOptimization();
+	beforeRefCamIdx = refCamIdx;
+	beforeCamNum    = getCameraNumber();
+	refineCount++;
 
-		// skip fail optimization
-		if (fitness > mvs.maxFitness) {
-			drop = true;
-			return;
-		}
+	return true;
+}
 
-		// update information
-		removeInvisibleCamera();
-		setReferenceCameraIndex();
-		setDepthAndRay();
-		setDepthRange();
-		setLOD();
+bool Patch::endOptimization() {
+	const MVS &mvs = MVS::getInstance();
 
-		if (type == TYPE_EXPAND) break;
+	// skip fail optimization
+	if (fitness > mvs.maxFitness) {
+		drop = true;
+		return false;
+	}
+
+	// update information
+	removeInvisibleCamera();
+	setReferenceCameraIndex();
+	setDepthAndRay();
+	setDepthRange();
+	setLOD();
 
-		afterRefCamIdx = refCamIdx;
-		afterCamNum    = getCameraNumber();
+	// re-optimization when reference camera index or visible cameras are changed
+	if (type != TYPE_EXPAND && 
+		(beforeRefCamIdx != refCamIdx || beforeCamNum != getCameraNumber()) && 
+		refineCount <= refineCamNum) {
+		return beginOptimization();
 	}
 
 	setPriority();
 	setImagePoint();
+
+	return false;
 }
 
 /* process */
@@ -180,45 +278,208 @@ void Patch::refine() {
 void Patch::psoOptimization() {
 	const MVS &mvs = MVS::getInstance();
 
-	// PSO parameter range (theta, phi, depth)
-    double rangeL [] = {0.0 , normalS[1] - M_PI/2.0, depthRange[0]};
-    double rangeU [] = {M_PI, normalS[1] + M_PI/2.0, depthRange[1]};
+	// reference window, weighting and images shared by all fitness evaluations
+	FitnessContext context(*this);
+	if ( !context.isInside() ) {
+		fitness = DBL_MAX;
+		return;
+	}
 
-    // initial guess particle
-    double init   [] = {normalS[0], normalS[1], depth};
+	clock_t start_t = clock();
 
-	PsoSolver *solver = NULL;
-	if (type == TYPE_SEED) {
-		solver = new PsoSolver(3, rangeL, rangeU, PAIS::getFitness, this, mvs.maxIteration*2, mvs.particleNum*2 );
-	} else {
-		// reduce normal search range for expansion patch
+	// global search, or initial guess only
+	Optimizer *solver = NULL;
+	if (getLocalRefinement() != MVS::LOCAL_ONLY) {
+		// optimizer reused by current thread
+		if (mvs.optimizer == MVS::OPTIMIZER_CMAES) {
+			solver = &CmaEs::getThreadSolver(3);
+		} else {
+			solver = &PsoSolver::getThreadSolver(3);
+		}
+		initOptimization(*solver, context);
+		solver->optimize();
+	}
+
+	setOptimizationResult(solver, context, start_t);
+}
+
+void Patch::getSearchRange(double *rangeL, double *rangeU, double *init) const {
+	const MVS &mvs = MVS::getInstance();
+
+	// PSO parameter range (theta, phi, depth)
+	rangeL[0] = 0.0;
+	rangeL[1] = normalS[1] - M_PI/2.0;
+	rangeL[2] = depthRange[0];
+	rangeU[0] = M_PI;
+	rangeU[1] = normalS[1] + M_PI/2.0;
+	rangeU[2] = depthRange[1];
+
+	// initial guess particle
+	init[0] = normalS[0];
+	init[1] = normalS[1];
+	init[2] = depth;
+
+	// reduce normal search range for expansion patch
+	if (type != TYPE_SEED) {
 		rangeL[0] = max(  0.0, normalS[0] - M_PI/mvs.reduceNormalRange);
 		rangeU[0] = min( M_PI, normalS[0] + M_PI/mvs.reduceNormalRange);
 		rangeL[1] = normalS[1] - M_PI/mvs.reduceNormalRange;
 		rangeU[1] = normalS[1] + M_PI/mvs.reduceNormalRange;
-		solver = new PsoSolver(3, rangeL, rangeU, PAIS::getFitness, this, mvs.maxIteration, mvs.particleNum);
 	}
+}
+
+int Patch::getLocalRefinement() const {
+	const MVS &mvs = MVS::getInstance();
+
+	// local refinement mode of patch type
+	return (type == TYPE_SEED) ? mvs.seedLocalRefinement : mvs.expansionLocalRefinement;
+}
+
+void Patch::initOptimization(Optimizer &solver, FitnessContext &context) const {
+	const MVS &mvs = MVS::getInstance();
+
+	double rangeL[3], rangeU[3], init[3];
+	getSearchRange(rangeL, rangeU, init);
+
+	solver.setFitness(PAIS::getFitness, &context);
+	// reproducible random streams of patch (run seed and patch id)
+	if (mvs.randomSeed >= 0) {
+		solver.setRandomSeed(((unsigned long long) mvs.randomSeed << 32) | (unsigned int) getId());
+	}
+	solver.setInitialization(mvs.swarmInitialization);
+	if (type == TYPE_SEED) {
+		solver.reset(rangeL, rangeU, init, mvs.maxIteration*2, mvs.particleNum*2);
+	} else {
+		solver.reset(rangeL, rangeU, init, mvs.maxIteration, mvs.particleNum);
+	}
+	// warm start from parent swarm
+	if (type == TYPE_EXPAND && mvs.warmStartNum > 0) {
+		setSwarmSummary(solver);
+	}
+	solver.setStopping(mvs.stagnationIteration, mvs.minImprovement, mvs.maxEvaluation);
+	// evaluate the whole swarm per fitness call, stop at pBest fitness
+	solver.setFitnessBatch(PAIS::getFitnessBatch);
+	solver.setFitnessBound(true);
+	// sparse window sampling for early iterations
+	if (mvs.coarseStride > 1) {
+		solver.setCoarseFitness(PAIS::setFitnessCoarse, (int) (solver.getMaxIteration() * mvs.coarseIterationRatio));
+	}
+}
 
-	clock_t start_t, end_t;
-	start_t = clock();
-	solver->setParticle(init);
-    solver->run(true);
-	end_t = clock();
+void Patch::setOptimizationResult(const Optimizer *solver, FitnessContext &context, const clock_t start_t) {
+	const MVS &mvs = MVS::getInstance();
+
+	double rangeL[3], rangeU[3], init[3];
+	getSearchRange(rangeL, rangeU, init);
+
+	// local refinement mode of patch type
+	const int localRefinement = getLocalRefinement();
+
+	// global search result, or initial guess only
+	int    iteration  = 0;
+	int    evaluation = 0;
+	int    stopReason = Optimizer::STOP_MAX_ITERATION;
+	double result[3];
+	if (solver != NULL) {
+		const double *gBest = solver->getGbest();
+		for (int d = 0; d < 3; d++) {
+			result[d] = gBest[d];
+		}
+		fitness    = solver->getGbestFitness();
+		iteration  = solver->getIteration();
+		evaluation = solver->getEvaluation();
+		stopReason = solver->getStopReason();
+	} else {
+		for (int d = 0; d < 3; d++) {
+			result[d] = init[d];
+		}
+		fitness = DBL_MAX;
+	}
+
+	// Nelder-Mead polishing of result
+	if (localRefinement != MVS::LOCAL_NONE) {
+		double step[3];
+		for (int d = 0; d < 3; d++) {
+			step[d] = (rangeU[d] - rangeL[d]) * mvs.localStepRatio;
+		}
+		NelderMead local(3, PAIS::getFitness, &context);
+		local.run(result, step, rangeL, rangeU, mvs.localIteration);
+		if (local.getBestFitness() < fitness) {
+			const double *best = local.getBest();
+			for (int d = 0; d < 3; d++) {
+				result[d] = best[d];
+			}
+			fitness = local.getBestFitness();
+		}
+		iteration  += local.getIteration();
+		evaluation += local.getEvaluation();
+		stopReason  = local.getStopReason();
+	}
+	const clock_t end_t = clock();
+
+	// final swarm for expansion patches
+	if (solver != NULL && mvs.warmStartNum > 0) {
+		getSwarmSummary(*solver);
+	}
 
 	// set refined patch information
-	fitness = solver->getGbestFitness();
-    const double *gBest = solver->getGbest();
-    setNormal(Vec2d(gBest[0], gBest[1]));
-    depth  = gBest[2];
+    setNormal(Vec2d(result[0], result[1]));
+    depth  = result[2];
 	center = ray * depth + mvs.getCamera(refCamIdx).getCenter();
 
+	// run counters
+	MVS::getInstance().addOptimizationStats(iteration, evaluation, stopReason);
 	if (type != TYPE_SEED)
-		LogManager::log("patch it\t%d\tsec\t%f", solver->getIteration(), (double)(end_t - start_t) / CLOCKS_PER_SEC);
+		LogManager::log("patch it\t%d\tsec\t%f\teval\t%d\tstop\t%s", iteration, (double)(end_t - start_t) / CLOCKS_PER_SEC, evaluation, Optimizer::getStopReasonName(stopReason));
+}
+
+void Patch::setSwarmSummary(Optimizer &solver) const {
+	const int num = (int) swarmCenters.size();
+	if (num == 0) return;
+
+	const Vec3d &refCenter = MVS::getInstance().getCamera(refCamIdx).getCenter();
+
+	// intersect own ray with inherited planes
+	vector<double> pos(num*3);
+	int n = 0;
+	for (int k = 0; k < num; ++k) {
+		Vec3d normal;
+		Utility::spherical2Normal(swarmNormals[k], normal);
+		const double cosine = normal.ddot(ray);
+		if (abs(cosine) < 1e-6) continue;
+		const double d = normal.ddot(swarmCenters[k] - refCenter) / cosine;
+		if (d <= 0) continue;
+		pos[n*3 + 0] = swarmNormals[k][0];
+		pos[n*3 + 1] = swarmNormals[k][1];
+		pos[n*3 + 2] = d;
+		n++;
+	}
 
-	delete solver;
+	if (n > 0) {
+		const double spread[] = {swarmSpread[0], swarmSpread[1], swarmSpread[2]};
+		solver.setSwarmSummary(&pos[0], n, spread);
+	}
 }
 
-void Patch::setCorrelationTable(const vector<Mat_<double>> &H) {
+void Patch::getSwarmSummary(const Optimizer &solver) {
+	const MVS &mvs = MVS::getInstance();
+	const Vec3d &refCenter = mvs.getCamera(refCamIdx).getCenter();
+
+	vector<double> pos(mvs.warmStartNum*3);
+	double spread[3];
+	const int n = solver.getSwarmSummary(mvs.warmStartNum, &pos[0], spread);
+
+	// planes in world coordinate, depth is along own ray
+	swarmCenters.resize(n);
+	swarmNormals.resize(n);
+	for (int k = 0; k < n; ++k) {
+		swarmNormals[k] = Vec2d(pos[k*3 + 0], pos[k*3 + 1]);
+		swarmCenters[k] = ray * pos[k*3 + 2] + refCenter;
+	}
+	swarmSpread = Vec3d(spread[0], spread[1], spread[2]);
+}
+
+void Patch::setCorrelationTable(const Matx33d *H) {
 	const MVS &mvs = MVS::getInstance();
 	const vector<Camera> &cameras = mvs.cameras;
 
@@ -266,7 +527,7 @@ void Patch::setCorrelationTable(const vector<Mat_<double>> &H) {
 	correlation /= (camNum*camNum-camNum);
 }
 
-double Patch::getHomographyRegionRatio(const Vec2d &pt, const Mat_<double> &H) const {
+double Patch::getHomographyRegionRatio(const Vec2d &pt, const Matx33d &H) const {
 	const int patchRadius = MVS::getInstance().patchRadius;
 
 	// 0 3
@@ -276,9 +537,9 @@ double Patch::getHomographyRegionRatio(const Vec2d &pt, const Mat_<double> &H) c
 	vector<Point2f> p(8);
 	double w;
 	for (int i = 0; i < 8; ++i) {
-		w       =   H.at<double>(2, 0) * x[i] + H.at<double>(2, 1) * y[i] + H.at<double>(2, 2);
-		p[i].x = ( H.at<double>(0, 0) * x[i] + H.at<double>(0, 1) * y[i] + H.at<double>(0, 2) ) / w;
-		p[i].y = ( H.at<double>(1, 0) * x[i] + H.at<double>(1, 1) * y[i] + H.at<double>(1, 2) ) / w;
+		w       =   H(2, 0) * x[i] + H(2, 1) * y[i] + H(2, 2);
+		p[i].x = ( H(0, 0) * x[i] + H(0, 1) * y[i] + H(0, 2) ) / w;
+		p[i].y = ( H(1, 0) * x[i] + H(1, 1) * y[i] + H(1, 2) ) / w;
 	}
 
 	// fit ellipse
@@ -287,49 +548,113 @@ double Patch::getHomographyRegionRatio(const Vec2d &pt, const Mat_<double> &H) c
 	return double( min(box.size.width, box.size.height) / max(box.size.width, box.size.height) );
 }
 
-void Patch::getHomographies(const Vec3d &center, const Vec3d &normal, vector<Mat_<double>> &H) const {
+// LOD scaled K*R and K*T, diag(s, s, 1)*KR and diag(s, s, 1)*KT
+static inline void getScaledProjection(const Camera &cam, const double lodScale, Matx33d &A, Vec3d &b) {
+	const Matx33d &KR = cam.getKR();
+	const Vec3d   &KT = cam.getKT();
+	for (int r = 0; r < 3; ++r) {
+		const double scale = (r < 2) ? lodScale : 1.0;
+		for (int c = 0; c < 3; ++c) {
+			A(r, c) = scale * KR(r, c);
+		}
+		b[r] = scale * KT[r];
+	}
+}
+
+// plane induced matrix M = d*A - b*n^T
+static inline void getPlaneMatrix(const Matx33d &A, const Vec3d &b, const double d, const Vec3d &n, Matx33d &M) {
+	for (int r = 0; r < 3; ++r) {
+		M(r, 0) = d*A(r, 0) - b[r]*n[0];
+		M(r, 1) = d*A(r, 1) - b[r]*n[1];
+		M(r, 2) = d*A(r, 2) - b[r]*n[2];
+	}
+}
+
+// closed-form 3x3 inverse (zero matrix if singular)
+static inline void invert3x3(const Matx33d &M, Matx33d &inv) {
+	const double c0 = M(1, 1)*M(2, 2) - M(1, 2)*M(2, 1);
+	const double c1 = M(1, 2)*M(2, 0) - M(1, 0)*M(2, 2);
+	const double c2 = M(1, 0)*M(2, 1) - M(1, 1)*M(2, 0);
+	const double det = M(0, 0)*c0 + M(0, 1)*c1 + M(0, 2)*c2;
+
+	if (det == 0) {
+		inv = Matx33d::zeros();
+		return;
+	}
+
+	const double s = 1.0 / det;
+	inv(0, 0) = c0 * s;
+	inv(0, 1) = (M(0, 2)*M(2, 1) - M(0, 1)*M(2, 2)) * s;
+	inv(0, 2) = (M(0, 1)*M(1, 2) - M(0, 2)*M(1, 1)) * s;
+	inv(1, 0) = c1 * s;
+	inv(1, 1) = (M(0, 0)*M(2, 2) - M(0, 2)*M(2, 0)) * s;
+	inv(1, 2) = (M(0, 2)*M(1, 0) - M(0, 0)*M(1, 2)) * s;
+	inv(2, 0) = c2 * s;
+	inv(2, 1) = (M(0, 1)*M(2, 0) - M(0, 0)*M(2, 1)) * s;
+	inv(2, 2) = (M(0, 0)*M(1, 1) - M(0, 1)*M(1, 0)) * s;
+}
+
+void Patch::getHomographies(const Vec3d &center, const Vec3d &normal, Matx33d *H) const {
+	getHomographies(&center, &normal, 1, H);
+}
+
+void Patch::getHomographies(const Vec3d *center, const Vec3d *normal, const int num, Matx33d *H) const {
+	const int camNum = getCameraNumber();
+
+	// scaled projections shared by all particles
+	Matx33d refA;
+	Vec3d   refB;
+	ScratchBuffer<Matx33d, FitnessKernel::STACK_CAMERA_NUM> A(camNum);
+	ScratchBuffer<Vec3d,   FitnessKernel::STACK_CAMERA_NUM> B(camNum);
+	getScaledProjections(refA, refB, &A[0], &B[0]);
+
+	getHomographies(refA, refB, &A[0], &B[0], center, normal, num, H);
+}
+
+void Patch::getScaledProjections(Matx33d &refA, Vec3d &refB, Matx33d *A, Vec3d *B) const {
 	const MVS &mvs = MVS::getInstance();
 	const vector<Camera> &cameras = mvs.getCameras();
+	const int camNum = getCameraNumber();
 
-	// camera parameters
-	const Camera &refCam  = mvs.getCamera(refCamIdx);
-	const Mat_<double> &KRF = refCam.getKR();
-	const Mat_<double> &KTF = refCam.getKT();
+	// LOD scalar for camera intrisic matrix K
+	const double lodScale = pow(mvs.lodRatio, LOD);
 
-	// plane equation (distance form plane to origin)
-	const double d = -center.ddot(normal);          
-	const Mat_<double> normalM(normal);
+	getScaledProjection(mvs.getCamera(refCamIdx), lodScale, refA, refB);
+	for (int i = 0; i < camNum; ++i) {
+		getScaledProjection(cameras[camIdx[i]], lodScale, A[i], B[i]);
+	}
+}
 
-	// set container
+void Patch::getHomographies(const Matx33d &refA, const Vec3d &refB, const Matx33d *A, const Vec3d *B, const Vec3d *center, const Vec3d *normal, const int num, Matx33d *H) const {
 	const int camNum = getCameraNumber();
-	H.resize(camNum);
 
-	// LOD scalar for camera intrisic matrix K
-	Mat_<double> LODM = Mat_<double>::zeros(3, 3);
-	LODM.at<double>(0, 0) = pow(mvs.lodRatio, LOD);
-	LODM.at<double>(1, 1) = pow(mvs.lodRatio, LOD);
-	LODM.at<double>(2, 2) = 1.0;
+	Matx33d M, invH;
+	for (int p = 0; p < num; ++p) {
+		// plane equation (distance form plane to origin)
+		const double d = -center[p].ddot(normal[p]);
 
-	// get homography from reference to target image
-	Mat_<double> invH = ( d*LODM*KRF - LODM*KTF*normalM.t() ).inv();
-	for (int i = 0; i < camNum; i++) {
-		// indentity for reference camera
-		if (camIdx[i] == refCamIdx) {
-			H[i] = Mat_<double>::eye(3, 3);
-			continue;
-		}
+		// inverse of reference plane induced matrix
+		getPlaneMatrix(refA, refB, d, normal[p], M);
+		invert3x3(M, invH);
 
-		// visible camera
-		const Camera &cam = cameras[camIdx[i]];
+		// get homography from reference to target image (camNum per particle)
+		for (int i = 0; i < camNum; ++i) {
+			Matx33d &h = H[p*camNum + i];
 
-		// get homography matrix
-		const Mat_<double> &KRT = cam.getKR();        // K*R of to camera
-		const Mat_<double> &KTT = cam.getKT();        // K*T of to camera
-		H[i] = ( d*LODM*KRT - LODM*KTT*normalM.t() ) * invH;
+			// indentity for reference camera
+			if (camIdx[i] == refCamIdx) {
+				h = Matx33d::eye();
+				continue;
+			}
+
+			// visible camera
+			getPlaneMatrix(A[i], B[i], d, normal[p], M);
+			h = M * invH;
+		}
 	}
 }
 
-void Patch::getHomographyPatch(const Vec2d &pt, const Mat_<uchar> &img, const Mat_<double> &H, Mat_<double> &hp) {
+void Patch::getHomographyPatch(const Vec2d &pt, const Mat_<uchar> &img, const Matx33d &H, Mat_<double> &hp) {
 
 	if (this->drop) return;
 
@@ -339,49 +664,16 @@ void Patch::getHomographyPatch(const Vec2d &pt, const Mat_<uchar> &img, const Ma
 
 	hp = Mat_<double>(patchSize*patchSize, 1);
 
-	double w, ix, iy;                // position on target image
-	int px[4];                       // neighbor x
-	int py[4];                       // neighbor y
-	int count = 0;
-	double sum = 0;
-	for (double x = pt[0]-patchRadius; x <= pt[0]+patchRadius; ++x) {
-		for (double y = pt[1]-patchRadius; y <= pt[1]+patchRadius; ++y) {
-			// homography projection (with LOD transform)
-			w  = ( H.at<double>(2, 0) * x + H.at<double>(2, 1) * y + H.at<double>(2, 2) );
-			ix = ( H.at<double>(0, 0) * x + H.at<double>(0, 1) * y + H.at<double>(0, 2) ) / w;
-			iy = ( H.at<double>(1, 0) * x + H.at<double>(1, 1) * y + H.at<double>(1, 2) ) / w;
-
-			// skip overflow cases
-			if (ix < 0 || ix >= img.cols-1 || iy < 0 || iy >= img.rows-1 || w == 0 || this->drop) {
-				// printf("ID %d \t corr overflow x:%f \t y:%f LOD:%d fit:%f\n", getId(), ix, iy, LOD, fitness);
-				#pragma omp critical 
-				{
-					this->drop = true;
-				}
-				return;
-			}
-
-			// interpolation neighbor points
-			px[0] = (int) ix;
-			py[0] = (int) iy;
-			px[1] = px[0] + 1;
-			py[1] = py[0];
-			px[2] = px[0];
-			py[2] = py[0] + 1;
-			px[3] = px[0] + 1;
-			py[3] = py[0] + 1;
-
-			hp.at<double>(count, 0) = (double) img.at<uchar>(py[0], px[0])*(px[1]-ix)*(py[2]-iy) + 
-					                  (double) img.at<uchar>(py[1], px[1])*(ix-px[0])*(py[2]-iy) + 
-					                  (double) img.at<uchar>(py[2], px[2])*(px[1]-ix)*(iy-py[0]) + 
-					                  (double) img.at<uchar>(py[3], px[3])*(ix-px[0])*(iy-py[0]);
-
-			sum += hp.at<double>(count, 0)*hp.at<double>(count, 0);
-			++count;
+	// warped window colors (with LOD transform), skip overflow cases
+	if ( !mvs.getKernelSet().warp(FitnessKernel::getImage(img), H, pt, patchRadius, (double *) hp.data) || this->drop ) {
+		#pragma omp critical 
+		{
+			this->drop = true;
 		}
+		return;
 	}
 
-	hp /= sqrt(sum);
+	hp /= norm(hp);
 	return;
 }
 
@@ -597,7 +889,9 @@ void Patch::setLOD() {
         for (int l = 0; l <= LOD; l++) {
             refCam.project(center, pt, l);
             sprintf(title, "LOD %d", l);
-			Mat img = refCam.getPyramidEdge(l).clone();
+			Mat_<double> img;
+			refCam.getPyramidEdge(l, img);
+			img = img.clone();
             circle(img, Point(cvRound(pt[0]), cvRound(pt[1])), max(patchRadius, 5), Scalar(255,0,0), 1, CV_AA);
             imshow(title, img);
             cvMoveWindow(title, 0, 0);
@@ -659,9 +953,10 @@ void Patch::removeInvisibleCamera() {
 	const int camNum = getCameraNumber();
 	const Camera &refCam = mvs.getCamera(refCamIdx);
 
-	vector<Mat_<double> > H;
-	getHomographies(center, normal, H);
-	setCorrelationTable(H);
+	// Homographies to visible camera
+	ScratchBuffer<Matx33d, FitnessKernel::STACK_CAMERA_NUM> H(camNum);
+	getHomographies(center, normal, &H[0]);
+	setCorrelationTable(&H[0]);
 
 	// sum correlation and find max correlation index
 	double corrSum;
@@ -776,8 +1071,8 @@ void Patch::showRefinedResult() const {
 	const Camera &refCam    = mvs.getCamera(refCamIdx);
 	
 	// Homographies to visible camera
-	vector<Mat_<double> > H(camNum);
-	getHomographies(center, normal, H);
+	ScratchBuffer<Matx33d, FitnessKernel::STACK_CAMERA_NUM> H(camNum);
+	getHomographies(center, normal, &H[0]);
 
 	Vec2d pt;
 	refCam.project(center, pt, LOD);
@@ -794,9 +1089,9 @@ void Patch::showRefinedResult() const {
 
 		// homography projection
 		for (int c = 0; c < 5; c++) {
-			w     =   H[i].at<double>(2, 0) * x[c] + H[i].at<double>(2, 1) * y[c] + H[i].at<double>(2, 2);
-			ix[c] = ( H[i].at<double>(0, 0) * x[c] + H[i].at<double>(0, 1) * y[c] + H[i].at<double>(0, 2) ) / w;
-			iy[c] = ( H[i].at<double>(1, 0) * x[c] + H[i].at<double>(1, 1) * y[c] + H[i].at<double>(1, 2) ) / w;
+			w     =   H[i](2, 0) * x[c] + H[i](2, 1) * y[c] + H[i](2, 2);
+			ix[c] = ( H[i](0, 0) * x[c] + H[i](0, 1) * y[c] + H[i](0, 2) ) / w;
+			iy[c] = ( H[i](1, 0) * x[c] + H[i](1, 1) * y[c] + H[i](1, 2) ) / w;
 			ix[c] = cvRound(ix[c]);
 			iy[c] = cvRound(iy[c]);
 		}
@@ -835,8 +1130,8 @@ void Patch::showError() const {
 	const int camNum = getCameraNumber();
 
 	// Homographies to visible camera
-	vector<Mat_<double> > H(camNum);
-	getHomographies(center, normal, H);
+	ScratchBuffer<Matx33d, FitnessKernel::STACK_CAMERA_NUM> H(camNum);
+	getHomographies(center, normal, &H[0]);
 
 	Vec2d pt;
 	refCam.project(center, pt, LOD);
@@ -859,9 +1154,9 @@ void Patch::showError() const {
 				const Mat_<uchar> &img = cameras[camIdx[i]].getPyramidImage(LOD);
 
 				// homography projection
-				w  =   H[i].at<double>(2, 0) * x + H[i].at<double>(2, 1) * y + H[i].at<double>(2, 2);
-				ix = ( H[i].at<double>(0, 0) * x + H[i].at<double>(0, 1) * y + H[i].at<double>(0, 2) ) / w;
-				iy = ( H[i].at<double>(1, 0) * x + H[i].at<double>(1, 1) * y + H[i].at<double>(1, 2) ) / w;
+				w  =   H[i](2, 0) * x + H[i](2, 1) * y + H[i](2, 2);
+				ix = ( H[i](0, 0) * x + H[i](0, 1) * y + H[i](0, 2) ) / w;
+				iy = ( H[i](1, 0) * x + H[i](1, 1) * y + H[i](1, 2) ) / w;
 				
 				// interpolation neighbor points
 				px[0] = (int) ix;
@@ -928,216 +1223,52 @@ bool Patch::centerDifferenceFiltering() const {
 	const int camNum = getCameraNumber();
 
 	// Homographies to visible camera
-	vector<Mat_<double> > H(camNum);
-	getHomographies(center, normal, H);
+	ScratchBuffer<Matx33d, FitnessKernel::STACK_CAMERA_NUM> H(camNum);
+	getHomographies(center, normal, &H[0]);
 
 	Vec2d pt;
 	refCam.project(center, pt, LOD);
 
-	// warping (get pixel-wised variance)
-	double CenterSAD,TotalSAD = 0;
-	double mean, avgSad;             // pixel-wised mean, avgSad
-	double w, ix, iy;                // position on target image
-	int px[4];                       // neighbor x
-	int py[4];                       // neighbor y
-	double *c = new double [camNum]; // bilinear color
-	Mat_<double> error(patchSize, patchSize);
-
-	for (double x = pt[0]-patchRadius, ex = 0; x <= pt[0]+patchRadius; x++, ex++) {
-		for (double y = pt[1]-patchRadius, ey = 0; y <= pt[1]+patchRadius; y++, ey++) {
-			// clear
-			mean = 0;
-			avgSad = 0;
-
-			for (int i = 0; i < camNum; i++) {
-				const Mat_<uchar> &img = cameras[camIdx[i]].getPyramidImage(LOD);
-
-				// homography projection
-				w  =   H[i].at<double>(2, 0) * x + H[i].at<double>(2, 1) * y + H[i].at<double>(2, 2);
-				ix = ( H[i].at<double>(0, 0) * x + H[i].at<double>(0, 1) * y + H[i].at<double>(0, 2) ) / w;
-				iy = ( H[i].at<double>(1, 0) * x + H[i].at<double>(1, 1) * y + H[i].at<double>(1, 2) ) / w;
-				
-				// interpolation neighbor points
-				px[0] = (int) ix;
-				py[0] = (int) iy;
-				px[1] = px[0] + 1;
-				py[1] = py[0];
-				px[2] = px[0];
-				py[2] = py[0] + 1;
-				px[3] = px[0] + 1;
-				py[3] = py[0] + 1;
-
-				for (int j = 0; j < 4; ++j) {
-					if ( !cameras[camIdx[i]].inImage(px[j], py[j], LOD) ) {
-						return false;
-					}
-				}
-
-				c[i] = (double) img.at<uchar>(py[0], px[0])*(px[1]-ix)*(py[2]-iy) + 
-					   (double) img.at<uchar>(py[1], px[1])*(ix-px[0])*(py[3]-iy) + 
-					   (double) img.at<uchar>(py[2], px[2])*(iy-py[0])*(px[3]-ix) + 
-					   (double) img.at<uchar>(py[3], px[3])*(ix-px[2])*(iy-py[1]);
-
-				mean += c[i];
-			} // end of camera
-
-			mean /= camNum;
+	// visible camera images
+	vector<FitnessImage> images(camNum);
+	for (int i = 0; i < camNum; ++i) {
+		images[i] = FitnessKernel::getImage(cameras[camIdx[i]].getPyramidImage(LOD));
+	}
 
-			for (int i = 0; i < camNum; i++) {
-				avgSad += abs(c[i]-mean);
-			}
-			avgSad /= camNum;
+	// warping (get pixel-wised variance)
+	vector<double> error(patchSize*patchSize);
+	if ( !mvs.getKernelSet().sad(&images[0], &H[0], camNum, pt, patchRadius, &error[0]) ) {
+		return false;
+	}
 
-			error.at<double>(ey, ex) = avgSad;
-			if(ex == patchRadius && ey == patchRadius)
-			{
-				CenterSAD = avgSad;
-			}
-			TotalSAD += avgSad;
-		} // end of warping y
-	} // end of warping x
-	TotalSAD /= (patchSize*1.0);
+	const double CenterSAD = error[patchRadius*patchSize + patchRadius];
 	if(CenterSAD > this->getFitness())
-		//TotalSAD)
 	{
 		return false;
 	}
 	return true;
 }
 
+
 /* fitness function */
 
 double PAIS::getFitness(const Particle &p, void *obj) {
-	// MVS
-	const MVS &mvs                = MVS::getInstance();
-	const int patchRadius         = mvs.getPatchRadius();
-	const int patchSize           = mvs.getPatchSize();
-	const vector<Camera> &cameras = mvs.getCameras();
-
-	// current patch
-	const Patch  &patch   = *((Patch *)obj);
-	// visible camera indices
-	const vector<int> &camIdx = patch.getCameraIndices();
-	// level of detail
-	int LOD = patch.getLOD();
-
-	// camera parameters
-	const Camera &refCam        = mvs.getCamera(patch.getReferenceCameraIndex());
-	const int camNum            = patch.getCameraNumber();
-	const Mat_<double> &edgeImg = refCam.getPyramidEdge(LOD);
-	const Mat_<uchar>  &refImg  = refCam.getPyramidImage(LOD);
-
-	// given patch normal
-	Vec3d normal;
-	Utility::spherical2Normal(Vec2d(p.pos[0], p.pos[1]), normal);
-
-	// skip inversed normal
-	if (normal.ddot(refCam.getOpticalNormal()) > 0) {
-        return DBL_MAX;
-    }
-
-	// given patch center
-	const Vec3d center = patch.getRay() * p.pos[2] + refCam.getCenter();
-
-	// Homographies to visible camera
-	vector<Mat_<double> > H(camNum);
-	patch.getHomographies(center, normal, H);
-
-	// projected point on reference image with LOD transform
-	Vec2d pt;
-	if ( !refCam.project(center, pt, LOD) ) {
-		return DBL_MAX;
-	}
-
-	// skip out of reference image bound patch
-	if (pt[0]-patchRadius < 2 || 
-		pt[0]+patchRadius >= edgeImg.cols-3 || 
-		pt[1]-patchRadius < 2 || 
-		pt[1]+patchRadius >= edgeImg.rows-3) {
-		return DBL_MAX;
-	}
-
-	// warping (get pixel-wised variance)
-	double mean, avgSad;             // pixel-wised mean, average sad
-	double w, ix, iy;                // position on target image
-	int px[4];                       // neighbor x
-	int py[4];                       // neighbor y
-	double *c = new double [camNum]; // bilinear color
-	double fitness = 0;              // result of normalized fitness
-
-	// distance & difference weighting weighting
-	const double diffWeighting = mvs.getDifferenceWeight();
-	const double gradientWeighting = mvs.getGradientWeight();
-	Mat_<double>::const_iterator it = mvs.getPatchDistanceWeighting().begin();
-	double weight;
-	double sumWeight = 0;
-
-	for (double x = pt[0]-patchRadius; x <= pt[0]+patchRadius; ++x) {
-		for (double y = pt[1]-patchRadius; y <= pt[1]+patchRadius; ++y, ++it) {
-			// clear
-			mean   = 0;
-			avgSad = 0;
+	// patch invariant fitness context
+	const FitnessContext &context = *((FitnessContext *)obj);
 
-			// skip background
-			if (refImg.at<uchar>(cvRound(y), cvRound(x)) == 0) continue;
-			// skip no gradient
-			// if (edgeImg.at<double>(cvRound(y), cvRound(x)) == 0.0) continue;
-
-			for (int i = 0; i < camNum; ++i) {
-				const Mat_<uchar> &img = cameras[camIdx[i]].getPyramidImage(LOD);
-
-				// homography projection
-				w  = ( H[i].at<double>(2, 0) * x + H[i].at<double>(2, 1) * y + H[i].at<double>(2, 2) );
-				ix = ( H[i].at<double>(0, 0) * x + H[i].at<double>(0, 1) * y + H[i].at<double>(0, 2) ) / w;
-				iy = ( H[i].at<double>(1, 0) * x + H[i].at<double>(1, 1) * y + H[i].at<double>(1, 2) ) / w;
-
-				// skip overflow cases
-				if (ix < 2 || ix >= img.cols-3 || iy < 2 || iy >= img.rows-3 || w == 0) {
-					delete [] c;
-					return DBL_MAX;
-				}
-				
-				// interpolation neighbor points
-				px[0] = (int) ix;
-				py[0] = (int) iy;
-				px[1] = px[0] + 1;
-				py[1] = py[0];
-				px[2] = px[0];
-				py[2] = py[0] + 1;
-				px[3] = px[0] + 1;
-				py[3] = py[0] + 1;
-				
-				c[i] = (double) img.at<uchar>(py[0], px[0])*(px[1]-ix)*(py[2]-iy) + 
-					   (double) img.at<uchar>(py[1], px[1])*(ix-px[0])*(py[2]-iy) + 
-					   (double) img.at<uchar>(py[2], px[2])*(px[1]-ix)*(iy-py[0]) + 
-					   (double) img.at<uchar>(py[3], px[3])*(ix-px[0])*(iy-py[0]);
-
-				mean += c[i];
-			} // end of camera
-
-			mean /= camNum;
+	return context.getFitness(p.pos);
+}
 
-			for (int i = 0; i < camNum; i++) {
-				avgSad += abs(c[i]-mean);
-			}
-			avgSad /= camNum;
+void PAIS::getFitnessBatch(const double *pos, const double *bound, const int dim, const int num, double *fitness, int *bounded, void *obj) {
+	// patch invariant fitness context
+	const FitnessContext &context = *((FitnessContext *)obj);
 
-			weight = 1;
-			if ( mvs.isAdaptiveDistanceEnable() ) {   // adaptive distance weighting
-				weight *= (*it);
-			}
-			if ( mvs.isAdaptiveDifferenceEnable() ) { // adaptive difference weighting
-				weight *= exp(-avgSad*avgSad/diffWeighting);
-			}
-			if ( mvs.isAdaptiveGradientEnable() ) {   // adaptive gradient maginitude weighting
-				weight *= exp( -1.0 / (edgeImg.at<double>(cvRound(y), cvRound(x))*gradientWeighting) );
-			}
-			sumWeight += weight;
-			fitness   += weight * avgSad;
-		} // end of warping y
-	} // end of warping x
+	context.getFitness(pos, num, bound, fitness, bounded);
+}
 
-	delete [] c;
+void PAIS::setFitnessCoarse(const bool coarse, void *obj) {
+	// patch invariant fitness context
+	FitnessContext &context = *((FitnessContext *)obj);
 
-	return fitness / sumWeight;
+	context.setCoarse(coarse);
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 
 #include "../io/logmanager.h"
 #include "../pso/psosolver.h"
+#include "../pso/neldermead.h"
+#include "../pso/cmaes.h"
+#include "../pso/batchsolver.h"
 #include "abstractpatch.h"
+#include "fitnesskernel.h"
 #include "mvs.h"
 
 using namespace PAIS;
@@ -11,6 +15,7 @@ using namespace cv;
 
 namespace PAIS {
 	class MVS;
+	class FitnessContext;
 
 	class Patch : public AbstractPatch {
 	private:
@@ -18,14 +23,43 @@ namespace PAIS {
 		static const int TYPE_EXPAND = 0x1;
 		bool drop;
 		int type;
+		// final swarm summary of last optimization, inherited by expansion patches
+		// (best pBest planes as center and spherical normal, velocity spread of theta, phi, depth)
+		vector<Vec3d> swarmCenters;
+		vector<Vec2d> swarmNormals;
+		Vec3d swarmSpread;
+		// re-optimization state of refinement (optimization counter, camera number before refinement,
+		// reference camera index and camera number before last optimization)
+		int refineCount;
+		int refineCamNum;
+		int beforeRefCamIdx;
+		int beforeCamNum;
 
-		void setCorrelationTable(const vector<Mat_<double>> &H);
+		void setCorrelationTable(const Matx33d *H);
 		// get homography texture 1D vector
-		void getHomographyPatch(const Vec2d &pt, const Mat_<uchar> &img, const Mat_<double> &H, Mat_<double> &hp);
+		void getHomographyPatch(const Vec2d &pt, const Mat_<uchar> &img, const Matx33d &H, Mat_<double> &hp);
 		// expand visible camera using normal correlation
 		void expandVisibleCamera();
 		// do pso optimization 
 		void psoOptimization();
+		// start refinement, false if patch is dropped before optimization
+		bool beginRefine();
+		// check patch before next optimization, false if dropped
+		bool beginOptimization();
+		// update patch after optimization, true if re-optimization is needed
+		bool endOptimization();
+		// search range and initial guess (theta, phi, depth)
+		void getSearchRange(double *rangeL, double *rangeU, double *init) const;
+		// local refinement mode of patch type
+		int getLocalRefinement() const;
+		// set up optimizer for patch fitness context
+		void initOptimization(Optimizer &solver, FitnessContext &context) const;
+		// local refinement and result of optimization (solver NULL for initial guess only)
+		void setOptimizationResult(const Optimizer *solver, FitnessContext &context, const clock_t start_t);
+		// warm start solver from inherited swarm summary re-expressed along own ray
+		void setSwarmSummary(Optimizer &solver) const;
+		// keep final swarm summary of solver for expansion patches
+		void getSwarmSummary(const Optimizer &solver);
 
 	protected:
 		void setEstimatedNormal();
@@ -39,6 +73,8 @@ namespace PAIS {
 	public:
 		static bool isNeighbor(const Patch &pth1, const Patch &pth2);
 		
+		// empty patch without id (released container slot)
+		Patch(void);
 		// seed patch constructor
 		Patch(const Vec3d &center, const Vec3b &color, const vector<int> &camIdx, const vector<Vec2d> &imgPoint, const int id = -1);
 		// expansion patch constructor
@@ -49,12 +85,20 @@ namespace PAIS {
 
 		void reCentering();
 		void refine();
+		// refine patches together, PSO runs of all patches advance in lockstep
+		static void refine(const vector<Patch*> &pths);
 		void removeInvisibleCamera();
 
-		// get homographies
-		void getHomographies(const Vec3d &center, const Vec3d &normal, vector<Mat_<double>> &H) const;
+		// get homographies into caller-owned array of camera number
+		void getHomographies(const Vec3d &center, const Vec3d &normal, Matx33d *H) const;
+		// get homographies of num particles into caller-owned array (camera number per particle)
+		void getHomographies(const Vec3d *center, const Vec3d *normal, const int num, Matx33d *H) const;
+		// get LOD scaled K*R and K*T of reference and visible cameras (A, B: camera number)
+		void getScaledProjections(Matx33d &refA, Vec3d &refB, Matx33d *A, Vec3d *B) const;
+		// get homographies of num particles from scaled projections, see getScaledProjections()
+		void getHomographies(const Matx33d &refA, const Vec3d &refB, const Matx33d *A, const Vec3d *B, const Vec3d *center, const Vec3d *normal, const int num, Matx33d *H) const;
 		// get homography region ratio
-		double getHomographyRegionRatio(const Vec2d &pt, const Mat_<double> &H) const;
+		double getHomographyRegionRatio(const Vec2d &pt, const Matx33d &H) const;
 		// show homography window in visible cameras
 		void showRefinedResult() const;
 		// show SAD error image
@@ -66,6 +110,8 @@ namespace PAIS {
 	};
 
 	double getFitness(const Particle &p, void *obj);
+	void getFitnessBatch(const double *pos, const double *bound, const int dim, const int num, double *fitness, int *bounded, void *obj);
+	void setFitnessCoarse(const bool coarse, void *obj);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "patchqueue.h"
+
+using namespace PAIS;
+
+PatchQueue::PatchQueue(const int queueOrder) {
+	reset(queueOrder);
+}
+
+PatchQueue::~PatchQueue(void) {
+
+}
+
+void PatchQueue::reset(const int queueOrder) {
+	this->queueOrder = queueOrder;
+	this->insertNum  = 0;
+	this->popped.id  = -1;
+	heap.clear();
+	position.clear();
+	ids.clear();
+}
+
+bool PatchQueue::before(const Entry &a, const Entry &b) const {
+	if (a.priority != b.priority) {
+		return (queueOrder == ORDER_MAX_PRIORITY) ? (a.priority > b.priority) : (a.priority < b.priority);
+	}
+	return a.order < b.order;
+}
+
+void PatchQueue::setEntry(const int pos, const Entry &entry) {
+	heap[pos] = entry;
+	position[entry.id] = pos;
+}
+
+void PatchQueue::siftUp(int pos) {
+	const Entry entry = heap[pos];
+	while (pos > 0) {
+		const int parent = (pos-1) >> 1;
+		if ( !before(entry, heap[parent]) ) break;
+		setEntry(pos, heap[parent]);
+		pos = parent;
+	}
+	setEntry(pos, entry);
+}
+
+void PatchQueue::siftDown(int pos) {
+	const int num = (int) heap.size();
+	const Entry entry = heap[pos];
+	while (true) {
+		int child = (pos << 1) + 1;
+		if (child >= num) break;
+		if (child+1 < num && before(heap[child+1], heap[child])) child++;
+		if ( !before(heap[child], entry) ) break;
+		setEntry(pos, heap[child]);
+		pos = child;
+	}
+	setEntry(pos, entry);
+}
+
+void PatchQueue::push(const int id, const double priority) {
+	if (id < 0) return;
+
+	if (queueOrder == ORDER_FIFO || queueOrder == ORDER_LIFO) {
+		ids.push_back(id);
+		return;
+	}
+
+	if (id >= (int) position.size()) {
+		position.resize(max(id+1, (int) position.size()*2), -1);
+	}
+
+	Entry entry;
+	entry.priority = priority;
+	entry.id       = id;
+
+	// update priority of queued id
+	const int pos = position[id];
+	if (pos >= 0) {
+		entry.order = heap[pos].order;
+		heap[pos]   = entry;
+		siftUp(pos);
+		siftDown(position[id]);
+		return;
+	}
+
+	entry.order = insertNum++;
+	insert(entry);
+}
+
+void PatchQueue::insert(const Entry &entry) {
+	heap.push_back(entry);
+	siftUp((int) heap.size()-1);
+}
+
+int PatchQueue::pop() {
+	int id = -1;
+
+	switch (queueOrder) {
+	case ORDER_FIFO:
+		if (ids.empty()) break;
+		id = ids.front();
+		ids.pop_front();
+		break;
+	case ORDER_LIFO:
+		if (ids.empty()) break;
+		id = ids.back();
+		ids.pop_back();
+		break;
+	default:
+		if (heap.empty()) break;
+		popped = heap[0];
+		id     = popped.id;
+		remove(id);
+		break;
+	}
+
+	return id;
+}
+
+void PatchQueue::unpop(const int id, const double priority) {
+	switch (queueOrder) {
+	case ORDER_FIFO:
+		ids.push_front(id);
+		break;
+	case ORDER_LIFO:
+		ids.push_back(id);
+		break;
+	default:
+		// new insertion order unless id is the last popped one
+		if (id != popped.id || position[id] >= 0) {
+			push(id, priority);
+			break;
+		}
+		popped.priority = priority;
+		insert(popped);
+		popped.id = -1;
+		break;
+	}
+}
+
+void PatchQueue::remove(const int id) {
+	if (id < 0 || id >= (int) position.size()) return;
+	const int pos = position[id];
+	if (pos < 0) return;
+
+	// move last entry to removed position
+	position[id] = -1;
+	const Entry last = heap.back();
+	heap.pop_back();
+	if (pos == (int) heap.size()) return;
+
+	setEntry(pos, last);
+	siftUp(pos);
+	siftDown(position[last.id]);
+}
@@ -0,0 +1,69 @@
+#ifndef __PAIS_PATCH_QUEUE_H__
+#define __PAIS_PATCH_QUEUE_H__
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+using namespace std;
+
+namespace PAIS {
+	// expansion queue of patch id, ordered by patch priority (indexed binary heap) or by insertion (deque)
+	// stale ids (deleted or expanded patches) are skipped by caller when popped
+	class PatchQueue {
+	public:
+		// queue order
+		static const int ORDER_MIN_PRIORITY = 0x00;
+		static const int ORDER_MAX_PRIORITY = 0x01;
+		static const int ORDER_FIFO         = 0x02;
+		static const int ORDER_LIFO         = 0x03;
+
+	private:
+		// heap entry, earlier insertion first for equal priority
+		struct Entry {
+			double priority;
+			int    order;
+			int    id;
+		};
+
+		int queueOrder;
+		// insertion counter
+		int insertNum;
+		// binary heap of priority orders
+		vector<Entry> heap;
+		// heap position of patch id (-1 if not in heap)
+		vector<int> position;
+		// deque of insertion orders
+		deque<int> ids;
+		// last popped heap entry (id -1 if none), keeps its insertion order when unpopped
+		Entry popped;
+
+		// entry a is popped before entry b
+		bool before(const Entry &a, const Entry &b) const;
+		void setEntry(const int pos, const Entry &entry);
+		void siftUp(int pos);
+		void siftDown(int pos);
+		// insert entry of id not in heap
+		void insert(const Entry &entry);
+
+	public:
+		PatchQueue(const int queueOrder = ORDER_MIN_PRIORITY);
+		~PatchQueue(void);
+
+		// clear queue and set order
+		void reset(const int queueOrder);
+		// insert patch id, update priority if id is already in heap
+		void push(const int id, const double priority);
+		// pop next patch id (-1 if empty)
+		int pop();
+		// return popped patch id to be popped next again
+		void unpop(const int id, const double priority);
+		// remove patch id from heap (deque ids are left for lazy deletion)
+		void remove(const int id);
+
+		int  size()  const { return (queueOrder == ORDER_FIFO || queueOrder == ORDER_LIFO) ? (int) ids.size() : (int) heap.size(); }
+		bool empty() const { return size() == 0; }
+	};
+};
+
+#endif
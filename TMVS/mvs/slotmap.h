@@ -0,0 +1,103 @@
+#ifndef __PAIS_SLOT_MAP_H__
+#define __PAIS_SLOT_MAP_H__
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+using namespace std;
+
+namespace PAIS {
+	// id keyed container of items in reusable slots
+	// O(1) id lookup, insertion and removal, items iterated by slot (0 ~ getSlotNum()-1, skip unused slots)
+	// items never move, pointers stay valid until their id is erased
+	// erased slots are reset to T() to release item resources
+	template <class T>
+	class SlotMap {
+	private:
+		// slot storage in blocks
+		deque<T> items;
+		// item id of each slot (-1 for free slot)
+		vector<int> itemId;
+		// slot of each id (-1 if id is not stored)
+		vector<int> slotIdx;
+		// free slots for reuse
+		vector<int> freeSlots;
+		// stored item number
+		int num;
+
+	public:
+		SlotMap(void) : num(0) {}
+		~SlotMap(void) {}
+
+		// insert item of id, false if id is already stored
+		bool insert(const int id, const T &item) {
+			if (id < 0) return false;
+			if (id >= (int) slotIdx.size()) {
+				slotIdx.resize(max(id+1, (int) slotIdx.size()*2), -1);
+			}
+			if (slotIdx[id] >= 0) return false;
+
+			int slot;
+			if (freeSlots.empty()) {
+				slot = (int) items.size();
+				items.push_back(item);
+				itemId.push_back(id);
+			} else {
+				slot = freeSlots.back();
+				freeSlots.pop_back();
+				items[slot]  = item;
+				itemId[slot] = id;
+			}
+			slotIdx[id] = slot;
+			num++;
+			return true;
+		}
+
+		// erase item of id, false if id is not stored
+		bool erase(const int id) {
+			const int slot = getSlot(id);
+			if (slot < 0) return false;
+			items[slot]  = T();
+			itemId[slot] = -1;
+			slotIdx[id]  = -1;
+			freeSlots.push_back(slot);
+			num--;
+			return true;
+		}
+
+		void clear() {
+			items.clear();
+			itemId.clear();
+			slotIdx.clear();
+			freeSlots.clear();
+			num = 0;
+		}
+
+		// slot of id (-1 if not stored)
+		int getSlot(const int id) const {
+			if (id < 0 || id >= (int) slotIdx.size()) return -1;
+			return slotIdx[id];
+		}
+		// item of id (NULL if not stored)
+		T* find(const int id) {
+			const int slot = getSlot(id);
+			return (slot < 0) ? NULL : &items[slot];
+		}
+		const T* find(const int id) const {
+			const int slot = getSlot(id);
+			return (slot < 0) ? NULL : &items[slot];
+		}
+
+		// slot iteration
+		int getSlotNum()                 const { return (int) items.size();   }
+		bool isUsed(const int slot)      const { return itemId[slot] >= 0;    }
+		T& at(const int slot)                  { return items[slot];          }
+		const T& at(const int slot)      const { return items[slot];          }
+
+		int  size()  const { return num;      }
+		bool empty() const { return num == 0; }
+	};
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "taskscheduler.h"
+#include "../io/logmanager.h"
+
+#if defined(_WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#define IDLE_YIELD() Sleep(0)
+	#define IDLE_SLEEP() Sleep(1)
+#else
+	#include <sched.h>
+	#include <unistd.h>
+	#define IDLE_YIELD() sched_yield()
+	#define IDLE_SLEEP() usleep(1000)
+#endif
+
+// idle rounds of yielding before sleeping 1 ms per round
+#define IDLE_YIELD_NUM 16
+
+using namespace PAIS;
+
+TaskScheduler::TaskScheduler(void) {
+	this->pending = 0;
+	this->runTime = 0;
+}
+
+TaskScheduler::~TaskScheduler(void) {
+	for (int i = 0; i < (int) workers.size(); ++i) {
+		omp_destroy_lock(&workers[i]->lock);
+		delete workers[i];
+	}
+	workers.clear();
+}
+
+bool TaskScheduler::compareTask(const Task &t1, const Task &t2) {
+	return (t1.priority < t2.priority);
+}
+
+void TaskScheduler::push(void (*run)(const int idx, void *obj), const int idx, void *obj, const double priority) {
+	Task task;
+	task.run      = run;
+	task.idx      = idx;
+	task.obj      = obj;
+	task.priority = priority;
+	initTasks.push_back(task);
+}
+
+void TaskScheduler::spawn(void (*run)(const int idx, void *obj), const int idx, void *obj, const double priority) {
+	Task task;
+	task.run      = run;
+	task.idx      = idx;
+	task.obj      = obj;
+	task.priority = priority;
+
+	#pragma omp atomic
+	pending++;
+
+	Worker &worker = *workers[omp_get_thread_num() % workers.size()];
+	omp_set_lock(&worker.lock);
+	worker.tasks.push_back(task);
+	omp_unset_lock(&worker.lock);
+}
+
+bool TaskScheduler::getTask(const int worker, Task &task) {
+	const int workerNum = (int) workers.size();
+
+	// own task from bottom
+	Worker &self = *workers[worker];
+	omp_set_lock(&self.lock);
+	if ( !self.tasks.empty() ) {
+		task = self.tasks.back();
+		self.tasks.pop_back();
+		omp_unset_lock(&self.lock);
+		return true;
+	}
+	omp_unset_lock(&self.lock);
+
+	// steal from top of other workers
+	for (int k = 1; k < workerNum; ++k) {
+		Worker &victim = *workers[(worker + k) % workerNum];
+		omp_set_lock(&victim.lock);
+		if ( !victim.tasks.empty() ) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			omp_unset_lock(&victim.lock);
+			self.stealNum++;
+			return true;
+		}
+		omp_unset_lock(&victim.lock);
+	}
+
+	return false;
+}
+
+void TaskScheduler::run() {
+	const int workerNum = max(1, omp_get_max_threads());
+
+	// workers of thread number
+	while ((int) workers.size() < workerNum) {
+		Worker *worker = new Worker();
+		omp_init_lock(&worker->lock);
+		worker->busyTime = 0;
+		worker->taskNum  = 0;
+		worker->stealNum = 0;
+		workers.push_back(worker);
+	}
+	for (int i = 0; i < (int) workers.size(); ++i) {
+		workers[i]->tasks.clear();
+	}
+
+	// deal tasks round robin in priority order, best task at bottom of each deque
+	stable_sort(initTasks.begin(), initTasks.end(), compareTask);
+	for (int i = 0; i < (int) initTasks.size(); ++i) {
+		workers[i % workers.size()]->tasks.push_front(initTasks[i]);
+	}
+	pending = (int) initTasks.size();
+	initTasks.clear();
+
+	const double start = omp_get_wtime();
+
+	#pragma omp parallel num_threads(workerNum)
+	{
+		const int worker = omp_get_thread_num() % (int) workers.size();
+		Task task;
+		int idleNum = 0;
+		while (true) {
+			if ( getTask(worker, task) ) {
+				const double taskStart = omp_get_wtime();
+				task.run(task.idx, task.obj);
+				workers[worker]->busyTime += omp_get_wtime() - taskStart;
+				workers[worker]->taskNum++;
+				idleNum = 0;
+
+				// follow-up tasks are pending before task is done
+				#pragma omp atomic
+				pending--;
+				continue;
+			}
+
+			// all tasks done (no atomic read in OpenMP 2.0, aligned int read after flush)
+			#pragma omp flush(pending)
+			if (pending == 0) break;
+
+			// back off while other workers run their last tasks
+			if (idleNum++ < IDLE_YIELD_NUM) {
+				IDLE_YIELD();
+			} else {
+				IDLE_SLEEP();
+			}
+		}
+	}
+
+	runTime += omp_get_wtime() - start;
+}
+
+void TaskScheduler::resetUtilization() {
+	runTime = 0;
+	for (int i = 0; i < (int) workers.size(); ++i) {
+		workers[i]->busyTime = 0;
+		workers[i]->taskNum  = 0;
+		workers[i]->stealNum = 0;
+	}
+}
+
+void TaskScheduler::printUtilization(const char *name) const {
+	for (int i = 0; i < (int) workers.size(); ++i) {
+		const Worker &worker = *workers[i];
+		const double utilization = (runTime > 0) ? worker.busyTime / runTime : 0;
+		printf("%s worker %d: busy %.1f%% \t tasks %d \t steals %d\n", name, i, utilization*100, worker.taskNum, worker.stealNum);
+		LogManager::log("%s worker\t%d\tbusy\t%f\ttasks\t%d\tsteals\t%d", name, i, utilization, worker.taskNum, worker.stealNum);
+	}
+}
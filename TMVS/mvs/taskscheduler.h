@@ -0,0 +1,70 @@
+#ifndef __PAIS_TASK_SCHEDULER_H__
+#define __PAIS_TASK_SCHEDULER_H__
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+// include openMP
+#include <omp.h>
+
+using namespace std;
+
+namespace PAIS {
+	// work-stealing scheduler of irregular tasks on OpenMP threads
+	// each worker runs its own deque from the bottom, idle workers steal from the top of others
+	class TaskScheduler {
+	public:
+		struct Task {
+			// task function of index and bundled object
+			void (*run)(const int idx, void *obj);
+			int   idx;
+			void *obj;
+			// priority hint (lower first)
+			double priority;
+		};
+
+	private:
+		struct Worker {
+			deque<Task> tasks;
+			omp_lock_t  lock;
+			// run counters since resetUtilization()
+			double busyTime;
+			int    taskNum;
+			int    stealNum;
+		};
+
+		// workers (one per thread)
+		vector<Worker*> workers;
+		// tasks added before run()
+		vector<Task> initTasks;
+		// queued and running tasks (atomic updates)
+		int pending;
+		// wall time of runs since resetUtilization()
+		double runTime;
+
+		static bool compareTask(const Task &t1, const Task &t2);
+
+		// pop own task from bottom or steal from top of other workers, false if none
+		bool getTask(const int worker, Task &task);
+
+	public:
+		TaskScheduler(void);
+		~TaskScheduler(void);
+
+		// add task before run()
+		void push(void (*run)(const int idx, void *obj), const int idx, void *obj, const double priority = 0);
+		// add follow-up task to current worker while running
+		void spawn(void (*run)(const int idx, void *obj), const int idx, void *obj, const double priority = 0);
+		// run added tasks and their follow-up tasks on all threads until none is left
+		// tasks are dealt round robin in priority order, best ones run first by each worker
+		// idle workers yield and then sleep until tasks show up or all are done
+		void run();
+		// clear busy time, task and steal number of workers
+		void resetUtilization();
+		// print and log busy time ratio, task and steal number of each worker since resetUtilization()
+		void printUtilization(const char *name) const;
+	};
+};
+
+#endif
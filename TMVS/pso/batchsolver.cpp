@@ -0,0 +1,83 @@
+#include "batchsolver.h"
+
+// batch solver reused by current OpenMP thread
+static BatchSolver *threadBatchSolver = NULL;
+#pragma omp threadprivate(threadBatchSolver)
+
+BatchSolver::BatchSolver(void) {
+	this->memberNum = 0;
+	this->roundNum  = 0;
+	this->taskNum   = 0;
+}
+
+BatchSolver::~BatchSolver(void) {
+	for (int i = 0; i < (int) solvers.size(); i++) {
+		delete solvers[i];
+	}
+	solvers.clear();
+}
+
+BatchSolver& BatchSolver::getThreadSolver() {
+	if (threadBatchSolver == NULL) {
+		threadBatchSolver = new BatchSolver();
+	}
+	return *threadBatchSolver;
+}
+
+void BatchSolver::setMemberNum(const int memberNum, const int dim) {
+	this->memberNum = memberNum;
+
+	// member solvers keep their buffers between batches
+	for (int i = 0; i < (int) solvers.size(); i++) {
+		if (solvers[i]->getDimension() != dim) {
+			delete solvers[i];
+			vector<double> range(dim, 0.0);
+			solvers[i] = new PsoSolver(dim, &range[0], &range[0]);
+		}
+	}
+	while ((int) solvers.size() < memberNum) {
+		vector<double> range(dim, 0.0);
+		solvers.push_back(new PsoSolver(dim, &range[0], &range[0]));
+	}
+
+	pending.assign(memberNum, 0);
+}
+
+void BatchSolver::run(const bool enableGLNPSO, const double minIw) {
+	roundNum = 0;
+	taskNum  = 0;
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int m = 0; m < memberNum; m++) {
+		pending[m] = solvers[m]->begin(enableGLNPSO, minIw);
+	}
+
+	while (true) {
+		// flatten pending particles of all members
+		tasks.clear();
+		for (int m = 0; m < memberNum; m++) {
+			for (int i = 0; i < pending[m]; i++) {
+				tasks.push_back(make_pair(m, i));
+			}
+		}
+		if (tasks.empty()) break;
+
+		const int num = (int) tasks.size();
+		taskNum += num;
+		roundNum++;
+
+		// one wide parallel loop over particles of all members
+		#pragma omp parallel for schedule(dynamic, 4)
+		for (int t = 0; t < num; t++) {
+			solvers[tasks[t].first]->evaluatePending(tasks[t].second);
+		}
+
+		// pBest, gBest, stopping rules and particle moves of each member
+		#pragma omp parallel for schedule(dynamic)
+		for (int m = 0; m < memberNum; m++) {
+			if (pending[m] > 0) {
+				pending[m] = solvers[m]->advance();
+			}
+		}
+	}
+}
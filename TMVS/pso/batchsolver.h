@@ -0,0 +1,50 @@
+#ifndef __PAIS_BATCH_SOLVER_H__
+#define __PAIS_BATCH_SOLVER_H__
+
+#include <vector>
+
+// include openMP
+#include <omp.h>
+
+#include "psosolver.h"
+
+using namespace std;
+
+namespace PAIS {
+	// independent PSO runs of many patches advanced in lockstep,
+	// pending particles of all runs are evaluated in one parallel loop each iteration
+	class BatchSolver {
+	private:
+		// member solvers, kept for later batches
+		vector<PsoSolver*> solvers;
+		// number of members in current batch
+		int memberNum;
+		// pending particle number of each member
+		vector<int> pending;
+		// pending (member, particle) pairs of current iteration
+		vector<pair<int, int> > tasks;
+		// lockstep iterations and evaluated particles of last run
+		int roundNum;
+		int taskNum;
+
+	public:
+		BatchSolver(void);
+		~BatchSolver(void);
+
+		// get batch solver reused by current OpenMP thread
+		static BatchSolver& getThreadSolver();
+
+		// set number of members of next batch, allocate member solvers of dim
+		void setMemberNum(const int memberNum, const int dim);
+		// member solver idx, set it up and reset() before run() (members may be set up concurrently)
+		PsoSolver& getSolver(const int idx) { return *solvers[idx]; }
+		// run all members in lockstep until every member is finished
+		void run(const bool enableGLNPSO = true, const double minIw = 0.4);
+
+		int getMemberNum() const { return memberNum; }
+		int getRoundNum()  const { return roundNum;  }
+		int getTaskNum()   const { return taskNum;   }
+	};
+};
+
+#endif
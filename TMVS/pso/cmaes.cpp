@@ -0,0 +1,341 @@
+#include "cmaes.h"
+
+using namespace PAIS;
+
+// optimizer reused by current OpenMP thread
+static CmaEs *threadCmaEs = NULL;
+#pragma omp threadprivate(threadCmaEs)
+
+const double CmaEs::INIT_SIGMA = 0.3;
+const double CmaEs::TOLERANCE  = 1e-4;
+
+// sort sample index by fitness
+struct SampleOrder {
+	const double *fitness;
+	bool operator()(const int i, const int j) const { return fitness[i] < fitness[j]; }
+};
+
+CmaEs::CmaEs(const int dim, double (*getFitness)(const Particle &p, void *obj), void *obj, int maxIteration, int lambda) : Optimizer(dim, getFitness, obj, maxIteration) {
+	this->initLambda     = lambda;
+	this->sigma          = INIT_SIGMA;
+	this->gBestFitness   = DBL_MAX;
+	this->gBestIteration = -1;
+
+	rangeL.assign(dim, 0.0);
+	rangeInter.assign(dim, 1.0);
+	mean.assign(dim, 0.5);
+	oldMean.assign(dim, 0.5);
+	pc.assign(dim, 0.0);
+	ps.assign(dim, 0.0);
+	C.assign(dim*dim, 0.0);
+	B.assign(dim*dim, 0.0);
+	D.assign(dim, 1.0);
+	gBest.assign(dim, 0.0);
+	step.assign(dim, 0.0);
+	bStep.assign(dim, 0.0);
+	eigen.assign(dim*dim, 0.0);
+
+	setRandomSeed();
+	setParameters();
+}
+
+CmaEs::~CmaEs(void) {
+}
+
+CmaEs& CmaEs::getThreadSolver(const int dim) {
+	if (threadCmaEs == NULL || threadCmaEs->getDimension() != dim) {
+		delete threadCmaEs;
+		threadCmaEs = new CmaEs(dim);
+	}
+	return *threadCmaEs;
+}
+
+void CmaEs::setRandomSeed() {
+	setRandomSeed((unsigned long long) time(NULL) + omp_get_thread_num());
+}
+
+void CmaEs::setRandomSeed(const unsigned long long seed) {
+	this->seed   = seed;
+	this->reseed = true;
+}
+
+double CmaEs::gaussian() {
+	// Box-Muller transform
+	const double u = 1.0 - rng.uniform();
+	const double v = rng.uniform();
+	return sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
+
+void CmaEs::setParameters() {
+	// default population size 4+3ln(n)
+	lambda = max(initLambda, 4 + (int) (3.0 * log((double) dim)));
+	mu     = lambda / 2;
+
+	// log-linear recombination weights
+	weights.resize(mu);
+	double sum = 0, sumSq = 0;
+	for (int i = 0; i < mu; i++) {
+		weights[i] = log(mu + 0.5) - log(i + 1.0);
+		sum += weights[i];
+	}
+	for (int i = 0; i < mu; i++) {
+		weights[i] /= sum;
+		sumSq += weights[i]*weights[i];
+	}
+	mueff = 1.0 / sumSq;
+
+	// adaptation rates
+	const double n = dim;
+	cc    = (4.0 + mueff/n) / (n + 4.0 + 2.0*mueff/n);
+	cs    = (mueff + 2.0) / (n + mueff + 5.0);
+	c1    = 2.0 / ((n + 1.3)*(n + 1.3) + mueff);
+	cmu   = min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0/mueff) / ((n + 2.0)*(n + 2.0) + mueff));
+	damps = 1.0 + 2.0 * max(0.0, sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+	chiN  = sqrt(n) * (1.0 - 1.0/(4.0*n) + 1.0/(21.0*n*n));
+
+	// sample buffers
+	z.resize(lambda*dim);
+	x.resize(lambda*dim);
+	xRange.resize(lambda*dim);
+	samplePos.resize(dim*lambda);
+	sampleFitness.resize(lambda);
+	sampleBounded.resize(lambda);
+	order.resize(lambda);
+}
+
+void CmaEs::reset(const double *rangeL, const double *rangeU, const double *init, const int maxIteration, const int lambda) {
+	this->maxIteration   = maxIteration;
+	this->initLambda     = lambda;
+	this->sigma          = INIT_SIGMA;
+	this->gBestFitness   = DBL_MAX;
+	this->gBestIteration = -1;
+
+	if (reseed) {
+		rng.setSeed(seed);
+		reseed = false;
+	}
+
+	for (int d = 0; d < dim; d++) {
+		this->rangeL[d]     = rangeL[d];
+		this->rangeInter[d] = rangeU[d] - rangeL[d];
+		// initial mean at initial guess or range center (normalized)
+		mean[d]  = (init != NULL && rangeInter[d] > 0) ? (init[d] - rangeL[d]) / rangeInter[d] : 0.5;
+		mean[d]  = min(max(mean[d], 0.0), 1.0);
+		gBest[d] = rangeL[d] + mean[d] * rangeInter[d];
+		pc[d] = 0;
+		ps[d] = 0;
+		D[d]  = 1;
+	}
+
+	// identity covariance
+	for (int i = 0; i < dim; i++) {
+		for (int j = 0; j < dim; j++) {
+			C[i*dim + j] = (i == j) ? 1.0 : 0.0;
+			B[i*dim + j] = (i == j) ? 1.0 : 0.0;
+		}
+	}
+
+	setParameters();
+}
+
+void CmaEs::samplePopulation() {
+	for (int k = 0; k < lambda; k++) {
+		double *zk = &z[k*dim];
+		double *xk = &x[k*dim];
+
+		for (int d = 0; d < dim; d++) {
+			zk[d] = gaussian();
+		}
+		// x = m + sigma * B * D * z, repaired into range
+		for (int i = 0; i < dim; i++) {
+			double y = 0;
+			for (int j = 0; j < dim; j++) {
+				y += B[i*dim + j] * D[j] * zk[j];
+			}
+			xk[i] = min(max(mean[i] + sigma * y, 0.0), 1.0);
+			xRange[k*dim + i]       = rangeL[i] + xk[i] * rangeInter[i];
+			samplePos[i*lambda + k] = xRange[k*dim + i];
+		}
+	}
+
+	// evaluate population
+	evaluation += lambda;
+	if (getFitnessBatch != NULL) {
+		getFitnessBatch(&samplePos[0], NULL, dim, lambda, &sampleFitness[0], &sampleBounded[0], obj);
+	} else {
+		#pragma omp parallel for
+		for (int k = 0; k < lambda; k++) {
+			const double *pos = &xRange[k*dim];
+			sampleFitness[k] = getFitness(Particle(dim, pos, NULL, pos, NULL), obj);
+		}
+	}
+
+	// rank samples
+	for (int k = 0; k < lambda; k++) {
+		order[k] = k;
+	}
+	SampleOrder sorter;
+	sorter.fitness = &sampleFitness[0];
+	sort(order.begin(), order.end(), sorter);
+
+	// update gBest
+	const int best = order[0];
+	if (sampleFitness[best] < gBestFitness) {
+		gBestFitness     = sampleFitness[best];
+		gBestIteration   = iteration;
+		improveIteration = iteration;
+		for (int d = 0; d < dim; d++) {
+			gBest[d] = xRange[best*dim + d];
+		}
+	}
+}
+
+void CmaEs::updateDistribution() {
+	// recombination
+	for (int d = 0; d < dim; d++) {
+		oldMean[d] = mean[d];
+		mean[d]    = 0;
+		for (int i = 0; i < mu; i++) {
+			mean[d] += weights[i] * x[order[i]*dim + d];
+		}
+	}
+
+	// step of mean in B basis: C^-1/2 * (m - m_old) / sigma = B * D^-1 * B' * (m - m_old) / sigma
+	const int n = dim;
+	for (int d = 0; d < n; d++) {
+		step[d] = (mean[d] - oldMean[d]) / sigma;
+	}
+	for (int j = 0; j < n; j++) {
+		bStep[j] = 0;
+		for (int i = 0; i < n; i++) {
+			bStep[j] += B[i*dim + j] * step[i];
+		}
+		bStep[j] /= D[j];
+	}
+
+	// step size evolution path
+	const double csn = sqrt(cs * (2.0 - cs) * mueff);
+	double psNorm = 0;
+	for (int i = 0; i < n; i++) {
+		double v = 0;
+		for (int j = 0; j < n; j++) {
+			v += B[i*dim + j] * bStep[j];
+		}
+		ps[i]   = (1.0 - cs) * ps[i] + csn * v;
+		psNorm += ps[i]*ps[i];
+	}
+	psNorm = sqrt(psNorm);
+
+	// covariance evolution path, stalled while step size is large
+	const double hsig = (psNorm / sqrt(1.0 - pow(1.0 - cs, 2.0 * (iteration + 1))) / chiN < 1.4 + 2.0 / (dim + 1.0)) ? 1.0 : 0.0;
+	const double ccn  = sqrt(cc * (2.0 - cc) * mueff);
+	for (int d = 0; d < n; d++) {
+		pc[d] = (1.0 - cc) * pc[d] + hsig * ccn * step[d];
+	}
+
+	// rank-one and rank-mu covariance update
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j <= i; j++) {
+			double rankMu = 0;
+			for (int k = 0; k < mu; k++) {
+				const double *xk = &x[order[k]*dim];
+				rankMu += weights[k] * (xk[i] - oldMean[i]) * (xk[j] - oldMean[j]);
+			}
+			rankMu /= sigma * sigma;
+
+			const double c = (1.0 - c1 - cmu) * C[i*dim + j] +
+			                 c1 * (pc[i]*pc[j] + (1.0 - hsig) * cc * (2.0 - cc) * C[i*dim + j]) +
+			                 cmu * rankMu;
+			C[i*dim + j] = c;
+			C[j*dim + i] = c;
+		}
+	}
+
+	// step size adaptation
+	sigma *= exp((cs / damps) * (psNorm / chiN - 1.0));
+
+	updateEigen();
+}
+
+void CmaEs::updateEigen() {
+	// Jacobi eigenvalue rotation of symmetric C, B holds eigenvectors as columns
+	double *A   = &eigen[0];
+	const int n = dim;
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			A[i*n + j]   = C[i*dim + j];
+			B[i*dim + j] = (i == j) ? 1.0 : 0.0;
+		}
+	}
+
+	for (int sweep = 0; sweep < 50; sweep++) {
+		double off = 0;
+		for (int i = 0; i < n; i++) {
+			for (int j = i+1; j < n; j++) {
+				off += A[i*n + j]*A[i*n + j];
+			}
+		}
+		if (off < 1e-30) break;
+
+		for (int p = 0; p < n; p++) {
+			for (int q = p+1; q < n; q++) {
+				if (abs(A[p*n + q]) < 1e-300) continue;
+				const double theta = (A[q*n + q] - A[p*n + p]) / (2.0 * A[p*n + q]);
+				const double t     = ((theta >= 0) ? 1.0 : -1.0) / (abs(theta) + sqrt(theta*theta + 1.0));
+				const double c     = 1.0 / sqrt(t*t + 1.0);
+				const double s     = t * c;
+
+				for (int k = 0; k < n; k++) {
+					const double akp = A[k*n + p];
+					const double akq = A[k*n + q];
+					A[k*n + p] = c*akp - s*akq;
+					A[k*n + q] = s*akp + c*akq;
+				}
+				for (int k = 0; k < n; k++) {
+					const double apk = A[p*n + k];
+					const double aqk = A[q*n + k];
+					A[p*n + k] = c*apk - s*aqk;
+					A[q*n + k] = s*apk + c*aqk;
+				}
+				for (int k = 0; k < n; k++) {
+					const double bkp = B[k*dim + p];
+					const double bkq = B[k*dim + q];
+					B[k*dim + p] = c*bkp - s*bkq;
+					B[k*dim + q] = s*bkp + c*bkq;
+				}
+			}
+		}
+	}
+
+	for (int d = 0; d < n; d++) {
+		D[d] = sqrt(max(A[d*n + d], 1e-20));
+	}
+}
+
+void CmaEs::optimize() {
+	resetCounters();
+
+	// initial guess
+	evaluation++;
+	gBestFitness = getFitness(Particle(dim, &gBest[0], NULL, &gBest[0], NULL), obj);
+
+	for (iteration = 0; iteration < maxIteration; iteration++) {
+		if ( isStopped(lambda, gBestFitness) ) {
+			break;
+		}
+
+		samplePopulation();
+		updateDistribution();
+
+		// converged by step size along longest axis
+		double maxD = 0;
+		for (int d = 0; d < dim; d++) {
+			maxD = max(maxD, D[d]);
+		}
+		if (sigma * maxD < TOLERANCE) {
+			iteration++;
+			stopReason = STOP_CONVERGENCE;
+			break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef __PAIS_CMAES_H__
+#define __PAIS_CMAES_H__
+
+#include <time.h>
+
+// include openMP
+#include <omp.h>
+
+#include "optimizer.h"
+#include "random.h"
+
+using namespace std;
+
+namespace PAIS {
+	// (mu/mu_w, lambda)-CMA-ES in range normalized coordinates
+	class CmaEs : public Optimizer {
+	private:
+		// initial step size (ratio of range)
+		static const double INIT_SIGMA;
+		// stop once step size along longest axis is below tolerance (ratio of range)
+		static const double TOLERANCE;
+
+		// population size and parents
+		int lambda;
+		int mu;
+		int initLambda; // requested population size before clamping to default
+
+		// recombination weights (mu) and strategy parameters
+		vector<double> weights;
+		double mueff;
+		double cc, cs, c1, cmu, damps, chiN;
+
+		// range
+		vector<double> rangeL;
+		vector<double> rangeInter;
+
+		// distribution mean, step size, evolution paths (dim)
+		vector<double> mean;
+		vector<double> oldMean;
+		double sigma;
+		vector<double> pc;
+		vector<double> ps;
+		// covariance matrix, eigenvectors (columns of row-major B) and eigenvalue square roots
+		vector<double> C;
+		vector<double> B;
+		vector<double> D;
+
+		// samples in normalized and range coordinates (lambda*dim), range coordinates in SoA order (dim*lambda)
+		vector<double> z;
+		vector<double> x;
+		vector<double> xRange;
+		vector<double> samplePos;
+		vector<double> sampleFitness;
+		vector<int>    sampleBounded;
+		vector<int>    order;
+		// mean step, its B basis coordinates (dim) and eigen decomposition buffer (dim*dim)
+		vector<double> step;
+		vector<double> bStep;
+		vector<double> eigen;
+
+		// best solution (range coordinates)
+		vector<double> gBest;
+		double gBestFitness;
+		int    gBestIteration;
+
+		// random stream
+		Random rng;
+		unsigned long long seed;
+		bool reseed;
+
+		// set random seed to current time and thread
+		void setRandomSeed();
+		// standard normal random number
+		double gaussian();
+
+		// set strategy parameters of population size
+		void setParameters();
+		// sample population and evaluate
+		void samplePopulation();
+		// update mean, evolution paths, covariance and step size
+		void updateDistribution();
+		// eigen decomposition of covariance matrix (Jacobi rotation)
+		void updateEigen();
+
+	public:
+		CmaEs(const int dim, double (*getFitness)(const Particle &p, void *obj) = NULL, void *obj = NULL, int maxIteration = 1000, int lambda = 0);
+		~CmaEs(void);
+
+		// get optimizer reused by current OpenMP thread (reset() before each run)
+		static CmaEs& getThreadSolver(const int dim);
+
+		// reuse optimizer for a new problem, lambda is clamped to at least the default 4+3ln(dim)
+		void reset(const double *rangeL, const double *rangeU, const double *init, const int maxIteration, const int lambda);
+		// set random seed of sampling stream, applied on next reset()
+		void setRandomSeed(const unsigned long long seed);
+		void optimize();
+
+		int           getPopulationNum()  const { return lambda;          }
+		double        getStepSize()       const { return sigma;           }
+		const double* getGbest()          const { return &gBest[0];       }
+		double        getGbestFitness()   const { return gBestFitness;    }
+		int           getGbestIteration() const { return gBestIteration;  }
+	};
+};
+
+#endif
\ No newline at end of file
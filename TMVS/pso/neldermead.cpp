@@ -0,0 +1,151 @@
+#include "neldermead.h"
+#include "optimizer.h"
+
+using namespace PAIS;
+
+NelderMead::NelderMead(const int dim, double (*getFitness)(const Particle &p, void *obj), void *obj) {
+	this->dim        = dim;
+	this->getFitness = getFitness;
+	this->obj        = obj;
+	this->rangeL     = NULL;
+	this->rangeU     = NULL;
+	this->iteration  = 0;
+	this->evaluation = 0;
+	this->stopReason = Optimizer::STOP_MAX_ITERATION;
+	this->best       = 0;
+
+	simplex.resize((dim+1)*dim);
+	simplexFitness.resize(dim+1);
+	centroid.resize(dim);
+	reflect.resize(dim);
+	expand.resize(dim);
+	contract.resize(dim);
+}
+
+NelderMead::~NelderMead(void) {
+}
+
+double NelderMead::evaluate(double *pos) {
+	// parameter bound check
+	for (int d = 0; d < dim; d++) {
+		if (pos[d] > rangeU[d]) pos[d] = rangeU[d];
+		if (pos[d] < rangeL[d]) pos[d] = rangeL[d];
+	}
+
+	evaluation++;
+	return getFitness(Particle(dim, pos, NULL, pos, NULL), obj);
+}
+
+void NelderMead::setPoint(const double *p, const double t, double *out) const {
+	for (int d = 0; d < dim; d++) {
+		out[d] = centroid[d] + t*(p[d] - centroid[d]);
+	}
+}
+
+void NelderMead::setVertex(const int idx, const double *pos, const double fitness) {
+	for (int d = 0; d < dim; d++) {
+		simplex[idx*dim + d] = pos[d];
+	}
+	simplexFitness[idx] = fitness;
+}
+
+void NelderMead::run(const double *init, const double *step, const double *rangeL, const double *rangeU, const int maxIteration, const double tolerance) {
+	this->rangeL     = rangeL;
+	this->rangeU     = rangeU;
+	this->iteration  = 0;
+	this->evaluation = 0;
+	this->stopReason = Optimizer::STOP_MAX_ITERATION;
+
+	// initial simplex: init and one step along each dimension (away from the nearer bound)
+	for (int i = 0; i <= dim; i++) {
+		double *v = &simplex[i*dim];
+		for (int d = 0; d < dim; d++) {
+			v[d] = init[d];
+		}
+		if (i > 0) {
+			const int d = i-1;
+			v[d] += (init[d] + step[d] <= rangeU[d]) ? step[d] : -step[d];
+		}
+		simplexFitness[i] = evaluate(v);
+	}
+
+	for (iteration = 0; iteration < maxIteration; iteration++) {
+		// best, worst and second worst vertices
+		int worst = 0, second = 0;
+		best = 0;
+		for (int i = 1; i <= dim; i++) {
+			if (simplexFitness[i] < simplexFitness[best])  best  = i;
+			if (simplexFitness[i] > simplexFitness[worst]) worst = i;
+		}
+		second = best;
+		for (int i = 0; i <= dim; i++) {
+			if (i != worst && simplexFitness[i] > simplexFitness[second]) second = i;
+		}
+
+		// converged by fitness spread
+		const double fBest  = simplexFitness[best];
+		const double fWorst = simplexFitness[worst];
+		if (fWorst - fBest <= tolerance * (abs(fBest) + DBL_EPSILON)) {
+			stopReason = Optimizer::STOP_CONVERGENCE;
+			break;
+		}
+
+		// centroid without worst vertex
+		for (int d = 0; d < dim; d++) {
+			centroid[d] = 0;
+			for (int i = 0; i <= dim; i++) {
+				if (i == worst) continue;
+				centroid[d] += simplex[i*dim + d];
+			}
+			centroid[d] /= dim;
+		}
+		const double *w = &simplex[worst*dim];
+
+		// reflection
+		setPoint(w, -1.0, &reflect[0]);
+		const double fReflect = evaluate(&reflect[0]);
+
+		if (fReflect < fBest) {
+			// expansion
+			setPoint(w, -2.0, &expand[0]);
+			const double fExpand = evaluate(&expand[0]);
+			if (fExpand < fReflect) {
+				setVertex(worst, &expand[0], fExpand);
+			} else {
+				setVertex(worst, &reflect[0], fReflect);
+			}
+			continue;
+		}
+
+		if (fReflect < simplexFitness[second]) {
+			setVertex(worst, &reflect[0], fReflect);
+			continue;
+		}
+
+		// contraction (outside if reflected point is better than worst, inside otherwise)
+		const bool outside = fReflect < fWorst;
+		setPoint(w, outside ? -0.5 : 0.5, &contract[0]);
+		const double fContract = evaluate(&contract[0]);
+		if (fContract < (outside ? fReflect : fWorst)) {
+			setVertex(worst, &contract[0], fContract);
+			continue;
+		}
+
+		// shrink toward best vertex
+		const double *b = &simplex[best*dim];
+		for (int i = 0; i <= dim; i++) {
+			if (i == best) continue;
+			double *v = &simplex[i*dim];
+			for (int d = 0; d < dim; d++) {
+				v[d] = b[d] + 0.5*(v[d] - b[d]);
+			}
+			simplexFitness[i] = evaluate(v);
+		}
+	}
+
+	// best vertex of final simplex
+	best = 0;
+	for (int i = 1; i <= dim; i++) {
+		if (simplexFitness[i] < simplexFitness[best]) best = i;
+	}
+}
\ No newline at end of file
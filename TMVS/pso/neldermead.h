@@ -0,0 +1,69 @@
+#ifndef __PAIS_NELDER_MEAD_H__
+#define __PAIS_NELDER_MEAD_H__
+
+#include <vector>
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+#include "particle.h"
+
+using namespace std;
+
+namespace PAIS {
+	// bounded Nelder-Mead simplex search, local refinement of a good initial guess
+	class NelderMead {
+	private:
+		// dimension of problem space
+		int dim;
+
+		// simplex vertices ((dim+1)*dim) and their fitness (dim+1)
+		vector<double> simplex;
+		vector<double> simplexFitness;
+		// centroid, reflected, expanded and contracted points (dim)
+		vector<double> centroid;
+		vector<double> reflect;
+		vector<double> expand;
+		vector<double> contract;
+
+		// parameter range
+		const double *rangeL;
+		const double *rangeU;
+
+		// fitness function and bundled object
+		double (*getFitness)(const Particle &p, void *obj);
+		void *obj;
+
+		// run counters
+		int iteration;
+		int evaluation;
+		int stopReason;
+
+		// best vertex
+		int best;
+
+		// fitness of bounded point (clamped into range)
+		double evaluate(double *pos);
+		// move point from centroid along direction (centroid + t*(p - centroid))
+		void setPoint(const double *p, const double t, double *out) const;
+		// replace worst vertex
+		void setVertex(const int idx, const double *pos, const double fitness);
+
+	public:
+		NelderMead(const int dim, double (*getFitness)(const Particle &p, void *obj), void *obj);
+		~NelderMead(void);
+
+		// minimize from init with initial simplex step of each dimension, stop once simplex fitness
+		// spread is below tolerance (relative) or after maxIteration iterations
+		void run(const double *init, const double *step, const double *rangeL, const double *rangeU, const int maxIteration, const double tolerance = 1e-3);
+
+		const double* getBest()         const { return &simplex[best*dim];  }
+		double        getBestFitness()  const { return simplexFitness[best]; }
+		int           getIteration()    const { return iteration;            }
+		int           getEvaluation()   const { return evaluation;           }
+		// stop reason, see Optimizer::STOP_MAX_ITERATION and Optimizer::STOP_CONVERGENCE
+		int           getStopReason()   const { return stopReason;           }
+	};
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "optimizer.h"
+
+using namespace PAIS;
+
+const char* Optimizer::getStopReasonName(const int reason) {
+	switch (reason) {
+	case STOP_MAX_ITERATION:
+		return "max iteration";
+	case STOP_CONVERGENCE:
+		return "convergence";
+	case STOP_STAGNATION:
+		return "stagnation";
+	case STOP_IMPROVEMENT:
+		return "improvement";
+	case STOP_BUDGET:
+		return "budget";
+	default:
+		return "unknown";
+	}
+}
+
+Optimizer::Optimizer(const int dim, double (*getFitness)(const Particle &p, void *obj), void *obj, const int maxIteration) {
+	this->dim                 = dim;
+	this->maxIteration        = maxIteration;
+	this->getFitness          = getFitness;
+	this->getFitnessBatch     = NULL;
+	this->obj                 = obj;
+	this->stagnationIteration = 0;
+	this->minImprovement      = 0;
+	this->maxEvaluation       = 0;
+	resetCounters();
+}
+
+Optimizer::~Optimizer(void) {
+}
+
+void Optimizer::resetCounters() {
+	iteration        = 0;
+	evaluation       = 0;
+	stopReason       = STOP_MAX_ITERATION;
+	improveIteration = 0;
+	gBestHistory.clear();
+}
+
+bool Optimizer::isStopped(const int num, const double gBestFitness, const bool comparable) {
+	// fitness evaluation budget of next iteration
+	if (maxEvaluation > 0 && evaluation + num > maxEvaluation) {
+		stopReason = STOP_BUDGET;
+		return true;
+	}
+
+	if (!comparable) return false;
+
+	// no gBest improvement
+	if (stagnationIteration > 0 && iteration - improveIteration >= stagnationIteration) {
+		stopReason = STOP_STAGNATION;
+		return true;
+	}
+
+	// relative gBest improvement over last stagnationIteration iterations
+	gBestHistory.push_back(gBestFitness);
+	const int last = (int) gBestHistory.size() - 1;
+	if (stagnationIteration > 0 && minImprovement > 0 && last >= stagnationIteration) {
+		const double prev = gBestHistory[last - stagnationIteration];
+		if (prev != DBL_MAX && prev != 0 && (prev - gBestFitness) / abs(prev) < minImprovement) {
+			stopReason = STOP_IMPROVEMENT;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Optimizer::setFitness(double (*getFitness)(const Particle &p, void *obj), void *obj) {
+	this->getFitness = getFitness;
+	this->obj        = obj;
+}
+
+void Optimizer::setFitnessBatch(void (*getFitnessBatch)(const double *pos, const double *bound, const int dim, const int num, double *fitness, int *bounded, void *obj)) {
+	this->getFitnessBatch = getFitnessBatch;
+}
+
+void Optimizer::setStopping(const int stagnationIteration, const double minImprovement, const int maxEvaluation) {
+	this->stagnationIteration = stagnationIteration;
+	this->minImprovement      = minImprovement;
+	this->maxEvaluation       = maxEvaluation;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef __PAIS_OPTIMIZER_H__
+#define __PAIS_OPTIMIZER_H__
+
+#include <vector>
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+#include "particle.h"
+
+using namespace std;
+
+namespace PAIS {
+	// common contract of patch optimizers: range, initial guess, fitness function, stopping rules and run counters
+	class Optimizer {
+	public:
+		// reason of stopping run
+		static const int STOP_MAX_ITERATION = 0x00;
+		static const int STOP_CONVERGENCE   = 0x01;
+		static const int STOP_STAGNATION    = 0x02;
+		static const int STOP_IMPROVEMENT   = 0x03;
+		static const int STOP_BUDGET        = 0x04;
+		static const int STOP_REASON_NUM    = 0x05;
+
+		// initial population sampling
+		static const int INIT_UNIFORM = 0x00;
+		static const int INIT_HALTON  = 0x01;
+
+		// get stop reason name
+		static const char* getStopReasonName(const int reason);
+
+	protected:
+		// dimension of problem space
+		int dim;
+
+		// number of iteration
+        int iteration;
+
+		// max number of iteration
+        int maxIteration;
+
+		// fitness function
+        double (*getFitness)(const Particle &p, void *obj);
+		// batched fitness function (positions in SoA order pos[d*num+i], fitness of each particle)
+		// evaluation may stop once fitness reaches bound, then bounded is non-zero and fitness is a lower bound
+		void (*getFitnessBatch)(const double *pos, const double *bound, const int dim, const int num, double *fitness, int *bounded, void *obj);
+		// bundled object for fitness function
+		void *obj;
+
+		// stop after stagnationIteration iterations without gBest improvement (0 disables)
+		int stagnationIteration;
+		// stop once relative gBest improvement over stagnationIteration iterations is below minImprovement (0 disables, needs stagnationIteration)
+		double minImprovement;
+		// stop before fitness evaluations exceed maxEvaluation (0 disables)
+		int maxEvaluation;
+
+		// run counters
+		int evaluation;
+		int stopReason;
+		// last iteration improving gBest fitness
+		int improveIteration;
+		// gBest fitness of each iteration since comparable fitness
+		vector<double> gBestHistory;
+
+		Optimizer(const int dim, double (*getFitness)(const Particle &p, void *obj), void *obj, const int maxIteration);
+
+		// clear run counters
+		void resetCounters();
+		// check stopping rules before next iteration of num evaluations, set stopReason
+		// stagnation and improvement rules are skipped while gBest fitness is not comparable
+		bool isStopped(const int num, const double gBestFitness, const bool comparable = true);
+
+	public:
+		virtual ~Optimizer(void);
+
+		// reuse optimizer for a new problem without reallocation, init is the initial guess (NULL for none)
+		// populationNum is the number of particles or samples per iteration
+		virtual void reset(const double *rangeL, const double *rangeU, const double *init, const int maxIteration, const int populationNum) = 0;
+		// set random seed for reproducible runs, applied on next reset()
+		virtual void setRandomSeed(const unsigned long long seed) = 0;
+		// minimize fitness from current state
+		virtual void optimize() = 0;
+		// best solution found
+		virtual const double* getGbest()        const = 0;
+		virtual double        getGbestFitness() const = 0;
+
+		// stop batched fitness evaluation early once it cannot improve (ignored if not supported)
+		virtual void setFitnessBound(const bool enable) {}
+		// initial population sampling, applied on next reset() (ignored if not supported)
+		virtual void setInitialization(const int initialization) {}
+		// summary of final population: best num solutions (num*dim, best first) and velocity spread (dim), return solution number (0 if not supported)
+		virtual int getSwarmSummary(const int num, double *pos, double *spread) const { return 0; }
+		// warm start from summary of another run after reset() (ignored if not supported)
+		virtual void setSwarmSummary(const double *pos, const int num, const double *spread) {}
+		// evaluate first coarseIteration iterations by coarse fitness (ignored if not supported)
+		virtual void setCoarseFitness(void (*setFitnessCoarse)(const bool coarse, void *obj), const int coarseIteration) {}
+
+		// set fitness function and bundled object
+		void setFitness(double (*getFitness)(const Particle &p, void *obj), void *obj);
+		// evaluate the whole population in one call instead of per particle
+		void setFitnessBatch(void (*getFitnessBatch)(const double *pos, const double *bound, const int dim, const int num, double *fitness, int *bounded, void *obj));
+		// stopping rules in addition to maxIteration and convergence (0 disables each)
+		void setStopping(const int stagnationIteration, const double minImprovement, const int maxEvaluation);
+
+		int getDimension()    const { return dim;          }
+        int getMaxIteration() const { return maxIteration; }
+		int getIteration()    const { return iteration;    }
+		int getEvaluation()   const { return evaluation;   }
+		int getStopReason()   const { return stopReason;   }
+	};
+};
+
+#endif
\ No newline at end of file
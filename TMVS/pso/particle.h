@@ -2,28 +2,30 @@
 #define __PAIS_PARTICLE_H__
 
 namespace PAIS {
+	// view of one particle in swarm storage of PsoSolver (does not own memory)
 	class Particle {
 	public:
 		// parameter dimension
         int dim;
         // best parameter
-        double *pBest;
+        const double *pBest;
 		// near neighbor best
-		double *nBest;
+		const double *nBest;
 		// local best
 		const double *lBest;
         // current parameter
-        double *pos;
+        const double *pos;
         // current velocity
-        double *vec;
+        const double *vec;
         // current fitness
         double fitness;
         // personal best fitness
         double pBestFitness;
+        // current fitness is only a lower bound (evaluation stopped early)
+        bool fitnessBounded;
 
-        Particle(int dim);
-        Particle(const Particle &p);
-        Particle& operator=(const Particle &p);
+        Particle(void);
+        Particle(int dim, const double *pos, const double *vec, const double *pBest, const double *nBest);
         ~Particle(void);
 	};
 };
@@ -1,5 +1,26 @@
 #include "psosolver.h"
 
+// prime bases of Halton sequence dimensions
+static const int HALTON_DIMENSION = 8;
+static const int HALTON_BASE[HALTON_DIMENSION] = {2, 3, 5, 7, 11, 13, 17, 19};
+
+// van der Corput radical inverse of index in base
+static double getRadicalInverse(int index, const int base) {
+	const double invBase = 1.0 / base;
+	double result = 0;
+	double digit  = invBase;
+	while (index > 0) {
+		result += (index % base) * digit;
+		index  /= base;
+		digit  *= invBase;
+	}
+	return result;
+}
+
+// solver reused by current OpenMP thread
+static PsoSolver *threadSolver = NULL;
+#pragma omp threadprivate(threadSolver)
+
 bool PsoSolver::sortLocalParticle (const LocalParticle &i, const LocalParticle &j) {
     return (i.dist < j.dist); 
 }
@@ -11,23 +32,33 @@ PsoSolver::PsoSolver(const int dim,
 				  int maxIteration, int particleNum,
 				  double convergenceThreshold, 
 				  double iw, double pw, double gw, double lw, double nw,
-				  int localK) {
-	this->dim            = dim;
-	this->maxIteration   = maxIteration;
-	this->getFitness     = getFitness;
-	this->obj            = obj;
+				  int localK) : Optimizer(dim, getFitness, obj, maxIteration) {
+	this->enableFitnessBound = false;
+	this->initialization     = INIT_UNIFORM;
+	this->setFitnessCoarse   = NULL;
+	this->coarseIteration    = 0;
+	this->coarse             = false;
+	this->enableGLNPSO       = true;
+	this->minIw              = 0.4;
+	this->phase              = PHASE_DONE;
 	this->particleNum    = particleNum;
 	this->convergenceThreshold = convergenceThreshold;
 	this->iw = iw;
+	this->initIw = iw;
 	this->pw = pw;
 	this->gw = gw;
 	this->lw = lw;
 	this->nw = nw;
 	this->localK = min(particleNum, localK);
+	this->initLocalK = localK;
 
 	this->rangeL         = new double[dim];
 	this->rangeU         = new double[dim];
 	this->rangeInter     = new double[dim];
+	this->pos            = NULL;
+	this->vec            = NULL;
+	this->pBest          = NULL;
+	this->nBest          = NULL;
 	this->gBest          = NULL;
 	this->gBestFitness   = DBL_MAX;
 	this->gBestIteration = -1;
@@ -57,22 +88,60 @@ PsoSolver::~PsoSolver() {
 	}
 }
 
-void PsoSolver::setRandomSeed() const {
+PsoSolver& PsoSolver::getThreadSolver(const int dim) {
+	if (threadSolver == NULL || threadSolver->getDimension() != dim) {
+		delete threadSolver;
+		vector<double> range(dim, 0.0);
+		threadSolver = new PsoSolver(dim, &range[0], &range[0]);
+	}
+	return *threadSolver;
+}
+
+void PsoSolver::reset(const double *rangeL, const double *rangeU, const double *init, const int maxIteration, const int particleNum) {
+	this->maxIteration   = maxIteration;
+	this->particleNum    = particleNum;
+	this->localK         = min(particleNum, initLocalK);
+	this->iw             = initIw;
+	this->gBest          = NULL;
+	this->gBestFitness   = DBL_MAX;
+	this->gBestIteration = -1;
+	this->setFitnessCoarse = NULL;
+	this->coarseIteration  = 0;
+	this->coarse           = false;
+
+	for (int i = 0; i < dim; i++) {
+		this->rangeL[i]     = rangeL[i];
+		this->rangeU[i]     = rangeU[i];
+		this->rangeInter[i] = rangeU[i] - rangeL[i];
+	}
+
+	// buffers keep their capacity
+	initParticles();
+	if (init != NULL) {
+		setParticle(init);
+	}
+}
+
+void PsoSolver::setRandomSeed() {
 	// set random seed
-	unsigned int seed = (unsigned int) time(NULL) + omp_get_thread_num();
-	srand(seed);
+	setRandomSeed((unsigned long long) time(NULL) + omp_get_thread_num());
+}
+
+void PsoSolver::setRandomSeed(const unsigned long long seed) {
+	this->seed   = seed;
+	this->reseed = true;
 }
 
-inline double PsoSolver::random() {
-	return ((double) rand()) / ((double) RAND_MAX);
+inline double PsoSolver::random(const int idx) {
+	return rng[idx].uniform();
 }
 
 double PsoSolver::getDispersionIDX() const {
 	double index = 0;
 	for (int i = 0; i < particleNum; i++) {
-		const Particle &p = particles[i];
+		const double *p = pos + i*dim;
 		for (int j = 0; j < dim; j++) {
-			index += abs(p.pos[j] - gBest[j]);
+			index += abs(p[j] - gBest[j]);
 		}
 	}
 	index /= (dim*particleNum);
@@ -81,189 +150,359 @@ double PsoSolver::getDispersionIDX() const {
 
 double PsoSolver::getVelocityIDX()   const {
 	double index = 0;
-	for (int i = 0; i < particleNum; i++) {
-		const Particle &p = particles[i];
-		for (int j = 0; j < dim; j++) {
-			index += abs(p.vec[j]);
-		}
+	for (int i = 0; i < particleNum*dim; i++) {
+		index += abs(vec[i]);
 	}
 	index /= (dim*particleNum);
 	return index;
 }
 
 void PsoSolver::initParticles() {
-	// allocate particle container
-	particles.clear();
-	particles.resize(particleNum, Particle(dim));
+	// seed particle streams
+	if (reseed || (int) rng.size() != particleNum) {
+		rng.resize(particleNum);
+		for (int i = 0; i < particleNum; i++) {
+			rng[i].setSeed(seed, i);
+		}
+		reseed = false;
+	}
 
-	// uniform random parameter between range
+	// gBest fitness of each iteration
+	gBestHistory.reserve(maxIteration + 1);
+
+	// allocate swarm arena
+	const int size = particleNum*dim;
+	swarm.assign(4*size, 0);
+	pos   = &swarm[0];
+	vec   = pos   + size;
+	pBest = vec   + size;
+	nBest = pBest + size;
+	fitness.assign(particleNum, DBL_MAX);
+	pBestFitness.assign(particleNum, DBL_MAX);
+	fitnessBounded.assign(particleNum, 0);
+	lBest.assign(particleNum, (const double *) NULL);
+	pBestDist.resize(particleNum*particleNum);
+	localParticles.resize(particleNum*particleNum);
+	bestParticles.resize(particleNum);
+	nBestFDR.resize(size);
+	batchPos.resize(size);
+	batchBound.resize(particleNum);
+
+	// random shift of Halton sequence (Cranley-Patterson rotation), shared by all particles
+	const bool halton = (initialization == INIT_HALTON);
+	initShift.resize(dim);
+	for (int d = 0; d < dim; d++) {
+		initShift[d] = halton ? random(0) : 0;
+	}
+
+	// uniform random or quasi-random parameter between range
 	for (int d = 0; d < dim; d++) {
 		for (int i = 0; i < particleNum; i++) {
+			const int idx = i*dim + d;
 			// random position parameter (L~U)
-            particles[i].pos[d] = (rangeInter[d] * random()) + rangeL[d];
+			double u;
+			if (halton && d < HALTON_DIMENSION) {
+				u = getRadicalInverse(i+1, HALTON_BASE[d]) + initShift[d];
+				if (u >= 1.0) u -= 1.0;
+			} else {
+				u = random(i);
+			}
+            pos[idx] = (rangeInter[d] * u) + rangeL[d];
             // random velocity parameter (-|U-L| ~ |U-L|), known as velocity inertia
-            particles[i].vec[d] = (2.0 * rangeInter[d] * random()) - rangeInter[d];
+            vec[idx] = (2.0 * rangeInter[d] * random(i)) - rangeInter[d];
             // set pBest as initial position
-            particles[i].pBest[d] = particles[i].pos[d];
+            pBest[idx] = pos[idx];
 		}
 	}
 }
 
-void PsoSolver::initFitness() {
-	#pragma omp parallel for
+int PsoSolver::prepareEvaluation(const bool bounded) {
+	evaluation += particleNum;
+
+	// gather positions in SoA order
+	for (int d = 0; d < dim; d++) {
+		for (int i = 0; i < particleNum; i++) {
+			batchPos[d*particleNum + i] = pos[i*dim + d];
+		}
+	}
+	// fitness not below pBest fitness never updates pBest
 	for (int i = 0; i < particleNum; i++) {
-		Particle &p    = particles[i];
-		p.fitness      = getFitness(p, obj);
-		p.pBestFitness = p.fitness;
+		batchBound[i] = (bounded && enableFitnessBound) ? pBestFitness[i] : DBL_MAX;
+	}
+
+	return particleNum;
+}
+
+void PsoSolver::evaluatePending() {
+	if (getFitnessBatch == NULL) {
+		#pragma omp parallel for
+		for (int i = 0; i < particleNum; i++) {
+			evaluatePending(i);
+		}
+		return;
+	}
+
+	getFitnessBatch(&batchPos[0], &batchBound[0], dim, particleNum, &fitness[0], &fitnessBounded[0], obj);
+}
+
+void PsoSolver::evaluatePending(const int idx) {
+	if (getFitnessBatch == NULL) {
+		fitness[idx]        = getFitness(getParticle(idx), obj);
+		fitnessBounded[idx] = 0;
+		return;
 	}
+
+	// position of one particle is its own SoA block
+	getFitnessBatch(pos + idx*dim, &batchBound[idx], dim, 1, &fitness[idx], &fitnessBounded[idx], obj);
+}
+
+void PsoSolver::initFitness() {
+	pBestFitness = fitness;
+	gBest        = pBest;
+	gBestFitness = pBestFitness[0];
+	updateGbest();
 }
 
 void PsoSolver::updateFitness() {
-	#pragma omp parallel for
 	for (int i = 0; i < particleNum; i++) {
-		Particle &p    = particles[i];
-		p.fitness      = getFitness(p, obj);
-
 		// update pBest
-		if (p.fitness < p.pBestFitness) {
-			p.pBestFitness = p.fitness;
-			for (int d = 0; d < p.dim; d++) {
-				p.pBest[d] = p.pos[d];
+		if (fitness[i] < pBestFitness[i]) {
+			pBestFitness[i] = fitness[i];
+			for (int d = 0; d < dim; d++) {
+				pBest[i*dim + d] = pos[i*dim + d];
 			}
 		}
 	} // end of update particles
 }
 
+int PsoSolver::beginRefine(const int phase) {
+	setFitnessCoarse(false, obj);
+	coarse = false;
+
+	// evaluate pBest positions by full fitness
+	swap(pos, pBest);
+	this->phase = phase;
+	return prepareEvaluation(false);
+}
+
+void PsoSolver::refineFitness() {
+	swap(pos, pBest);
+	pBestFitness = fitness;
+
+	// coarse gBest fitness is not comparable
+	gBestFitness = DBL_MAX;
+	updateGbest();
+	improveIteration = iteration;
+	gBestHistory.clear();
+}
+
 void PsoSolver::updateGbest() {
 	for (int j = 0; j < particleNum; j++) {
-        // current particle
-        const Particle &p = particles[j];
-
-		if (p.pBestFitness <= gBestFitness) {
-            gBestFitness   = p.pBestFitness;
-			gBest          = p.pBest;
+		if (pBestFitness[j] <= gBestFitness) {
+			// strict improvement for stagnation rule
+			if (pBestFitness[j] < gBestFitness) improveIteration = iteration;
+            gBestFitness   = pBestFitness[j];
+			gBest          = pBest + j*dim;
 			gBestIteration = iteration;
 			// printf("update: %f\n", gBestFitness);
         }
     }
 }
 
-const double* PsoSolver::getLocalBest(const int idx) const {
-	// local particle container
-	vector<LocalParticle> container(particleNum);
-
-	// current pBest position
-	const double *pos = particles[idx].pBest;
-
-	// get Euclidean distence from pBest to current pBest position
+void PsoSolver::setNeighborhood() {
+	// pairwise Euclidean distance of pBest, symmetric
 	for (int i = 0; i < particleNum; i++) {
-		const Particle &p = particles[i];
-		LocalParticle &localP = container[i];
-		localP.dist = 0;
-		localP.p = &p;
-
-		if (i == idx) {
-			localP.dist = DBL_MAX;
-			continue;
+		const double *pi = pBest + i*dim;
+		pBestDist[i*particleNum + i] = DBL_MAX;
+		for (int j = i+1; j < particleNum; j++) {
+			const double *pj = pBest + j*dim;
+			double dist = 0;
+			for (int d = 0; d < dim; d++) {
+				dist += (pi[d] - pj[d])*(pi[d] - pj[d]);
+			}
+			pBestDist[i*particleNum + j] = dist;
+			pBestDist[j*particleNum + i] = dist;
 		}
+	}
 
-		for (int d = 0; d < dim; d++) {
-			localP.dist += (pos[d] - p.pBest[d])*(pos[d] - p.pBest[d]);
-		}
+	#pragma omp parallel for
+	for (int i = 0; i < particleNum; i++) {
+		setLocalBest(i);
+		setNearNeighborBest(i);
+	}
+}
+
+void PsoSolver::setLocalBest(const int idx) {
+	// local particle container of idx
+	LocalParticle *container = &localParticles[idx*particleNum];
+	const double  *dist      = &pBestDist[idx*particleNum];
+
+	for (int i = 0; i < particleNum; i++) {
+		container[i].dist = dist[i];
+		container[i].idx  = i;
 	}
 
-	// sort by distance
-	sort(container.begin(), container.end(), sortLocalParticle);
+	// select localK nearest neighbors
+	if (localK > 0) {
+		nth_element(container, container + localK - 1, container + particleNum, sortLocalParticle);
+	}
 
 	// find the minimum fitness pbest as lbest from localK nearest neighbors
 	double minFitness = DBL_MAX;
-	const double *lBest = pos;
+	lBest[idx] = pBest + idx*dim;
 	for (int k = 0; k < localK; k++) {
 		const LocalParticle &localP = container[k];
-		const Particle &p = *localP.p;
-		if (p.pBestFitness < minFitness) {
-			minFitness = p.pBestFitness;
-			lBest = p.pBest;
+		if (pBestFitness[localP.idx] < minFitness) {
+			minFitness = pBestFitness[localP.idx];
+			lBest[idx] = pBest + localP.idx*dim;
 		}
 	}
-
-	return lBest;
 }
 
 void PsoSolver::setNearNeighborBest(const int idx) {
 	// current fitness
-	const double fitness = particles[idx].fitness;
+	const double fitness = this->fitness[idx];
 	// current position
-	const double *pos    = particles[idx].pos;
+	const double *pos    = this->pos + idx*dim;
 	// near neighbor best
-	double *nBest = particles[idx].nBest;
+	double *nBest = this->nBest + idx*dim;
 
-	double FDR;
-	double maxFDR;
+	// maximum fitness distance ratio of each dimension
+	double *maxFDR = &nBestFDR[idx*dim];
+	for (int d = 0; d < dim; d++) {
+		maxFDR[d] = -DBL_MAX;
+	}
 
-	for (int d = 0; d < dim; d++) { // loop dimension
-		maxFDR = -DBL_MAX;
-		for (int i = 0; i < particleNum; i++) { // loop particle
-			if (i == idx) continue; // skip current particle
-			const Particle &p = particles[i];
+	// one pass over contiguous pBest of other particles
+	for (int i = 0; i < particleNum; i++) { // loop particle
+		if (i == idx) continue; // skip current particle
+		const double *p    = pBest + i*dim;
+		const double  diff = fitness - pBestFitness[i];
 
-			FDR = (fitness - p.pBestFitness) / abs(pos[d] - p.pBest[d]);
+		for (int d = 0; d < dim; d++) { // loop dimension
+			const double FDR = diff / abs(pos[d] - p[d]);
 
-			if (FDR > maxFDR) {
-				maxFDR = FDR;
-				nBest[d] = p.pBest[d];
+			if (FDR > maxFDR[d]) {
+				maxFDR[d] = FDR;
+				nBest[d]  = p[d];
 			}
 		}
 	}
 }
 
 void PsoSolver::moveParticles() {
-	
+	// neighborhood of all particles from current pBest
+	if (enableGLNPSO) {
+		setNeighborhood();
+	}
+
 	#pragma omp parallel for
 	for (int i = 0; i < particleNum; i++) {
 		// velocity weighting
 		double pVecW, gVecW, lVecW, nVecW;
 
 		// current particle
-		Particle &p = particles[i];
+		double *pos         = this->pos   + i*dim;
+		double *vec         = this->vec   + i*dim;
+		const double *pBest = this->pBest + i*dim;
+		const double *nBest = this->nBest + i*dim;
 
 		// get random weighting w * [0 ~ 1]
 		// pBest, gBest, lBest, nBest weighting noise
-		pVecW = pw * random();
-        gVecW = gw * random();
+		pVecW = pw * random(i);
+        gVecW = gw * random(i);
 
 		if (enableGLNPSO) {
-			lVecW = lw * random();
-			nVecW = nw * random();
-			p.lBest = getLocalBest(i);
-			setNearNeighborBest(i);
+			lVecW = lw * random(i);
+			nVecW = nw * random(i);
 		}
 		
 		for (int d = 0; d < dim; d++) {
 			// update velocity
 			if (enableGLNPSO) {
-				p.vec[d] = iw*p.vec[d]                 + 
-					       pVecW*(p.pBest[d]-p.pos[d]) +
-						   gVecW*(gBest[d]-p.pos[d])   + 
-						   lVecW*(p.lBest[d]-p.pos[d]) +
-						   nVecW*(p.nBest[d]-p.pos[d]);
+				vec[d] = iw*vec[d]                 + 
+					     pVecW*(pBest[d]-pos[d])    +
+						 gVecW*(gBest[d]-pos[d])    + 
+						 lVecW*(lBest[i][d]-pos[d]) +
+						 nVecW*(nBest[d]-pos[d]);
 			} else {
-				p.vec[d] = iw*p.vec[d]                 + 
-					       pVecW*(p.pBest[d]-p.pos[d]) +
-						   gVecW*(gBest[d]-p.pos[d]);
+				vec[d] = iw*vec[d]                 + 
+					     pVecW*(pBest[d]-pos[d])    +
+						 gVecW*(gBest[d]-pos[d]);
 			}
 
 			// update position
-			p.pos[d] += p.vec[d];
+			pos[d] += vec[d];
 
 			// parameter bound check
-            if (p.pos[d] > rangeU[d]) p.pos[d] = rangeU[d];
-            if (p.pos[d] < rangeL[d]) p.pos[d] = rangeL[d];
+            if (pos[d] > rangeU[d]) pos[d] = rangeU[d];
+            if (pos[d] < rangeL[d]) pos[d] = rangeL[d];
 		} // end of velocity dimension
 
 	} // end of move particles
 }
 
+int PsoSolver::getSwarmSummary(const int num, double *pos, double *spread) const {
+	// best num pBest
+	const int n = min(num, particleNum);
+	for (int i = 0; i < particleNum; i++) {
+		bestParticles[i].dist = pBestFitness[i];
+		bestParticles[i].idx  = i;
+	}
+	if (n > 0) {
+		partial_sort(bestParticles.begin(), bestParticles.begin() + n, bestParticles.end(), sortLocalParticle);
+	}
+	for (int k = 0; k < n; k++) {
+		const double *p = pBest + bestParticles[k].idx*dim;
+		for (int d = 0; d < dim; d++) {
+			pos[k*dim + d] = p[d];
+		}
+	}
+
+	// velocity spread of swarm
+	for (int d = 0; d < dim; d++) {
+		spread[d] = 0;
+		for (int i = 0; i < particleNum; i++) {
+			spread[d] += abs(vec[i*dim + d]);
+		}
+		spread[d] /= particleNum;
+	}
+
+	return n;
+}
+
+void PsoSolver::setSwarmSummary(const double *pos, const int num, const double *spread) {
+	// particle 0 keeps initial guess
+	const int n = min(num, particleNum-1);
+	for (int k = 0; k < n; k++) {
+		const int i = k+1;
+		for (int d = 0; d < dim; d++) {
+			const int idx = i*dim + d;
+			this->pos[idx] = min(max(pos[k*dim + d], rangeL[d]), rangeU[d]);
+			this->vec[idx] = spread[d] * (2.0 * random(i) - 1.0);
+			pBest[idx]     = this->pos[idx];
+		}
+	}
+}
+
+void PsoSolver::setInitialization(const int initialization) {
+	this->initialization = initialization;
+}
+
+void PsoSolver::setCoarseFitness(void (*setFitnessCoarse)(const bool coarse, void *obj), const int coarseIteration) {
+	this->setFitnessCoarse = setFitnessCoarse;
+	this->coarseIteration  = coarseIteration;
+}
+
+Particle PsoSolver::getParticle(const int idx) const {
+	Particle p(dim, pos + idx*dim, vec + idx*dim, pBest + idx*dim, nBest + idx*dim);
+	p.lBest          = lBest[idx];
+	p.fitness        = fitness[idx];
+	p.pBestFitness   = pBestFitness[idx];
+	p.fitnessBounded = fitnessBounded[idx] != 0;
+	return p;
+}
+
 bool PsoSolver::setParticle(const double *pos, const double *vec, const int idx) {
 	if (pos == NULL) {
 		printf("set particle fail\n");
@@ -271,36 +510,101 @@ bool PsoSolver::setParticle(const double *pos, const double *vec, const int idx)
 	}
 
 	for (int d = 0; d < dim; d++) {
-		particles[idx].pos[d]   = pos[d];
-		particles[idx].pBest[d] = particles[idx].pos[d];
+		this->pos[idx*dim + d]   = pos[d];
+		this->pBest[idx*dim + d] = pos[d];
 		if ( vec != NULL) {
-			particles[idx].vec[d] = vec[d];
+			this->vec[idx*dim + d] = vec[d];
 		} else {
-			particles[idx].vec[d] = (2.0 * rangeInter[d] * random()) - rangeInter[d];
+			this->vec[idx*dim + d] = (2.0 * rangeInter[d] * random(idx)) - rangeInter[d];
 		}
 	}
 
 	return true;
 }
 
-void PsoSolver::run(const bool enableGLNPSO, const double minIw) {
+int PsoSolver::begin(const bool enableGLNPSO, const double minIw) {
 	this->enableGLNPSO = enableGLNPSO;
-	initFitness();
-	gBest        = particles[0].pBest;
-	gBestFitness = particles[0].pBestFitness;
-	updateGbest();
+	this->minIw        = minIw;
 
-	for (iteration = 0; iteration < maxIteration; iteration++) {
+	// coarse fitness for early iterations, if budget has a full refine pass after initial swarm
+	coarse = (setFitnessCoarse != NULL && coarseIteration > 0) && (maxEvaluation <= 0 || maxEvaluation >= 2*particleNum);
+	if (coarse) {
+		setFitnessCoarse(true, obj);
+	}
 
-		if (getDispersionIDX() < convergenceThreshold && getVelocityIDX() < convergenceThreshold) {
-			break;
-		}
+	resetCounters();
+	iteration = 0;
 
-		moveParticles();
+	phase = PHASE_INIT;
+	return prepareEvaluation(false);
+}
+
+int PsoSolver::advance() {
+	switch (phase) {
+	case PHASE_INIT:
+		initFitness();
+		break;
+	case PHASE_MOVE:
 		updateFitness();
 		updateGbest();
 
 		// linear interia weighting adjustment
 		iw = max(iw - 1.0/maxIteration, minIw);
-	} // end of iteration
+		iteration++;
+		break;
+	case PHASE_REFINE:
+		refineFitness();
+		break;
+	case PHASE_FINAL:
+		refineFitness();
+		phase = PHASE_DONE;
+		return 0;
+	default:
+		return 0;
+	}
+
+	return nextIteration();
+}
+
+int PsoSolver::nextIteration() {
+	if (iteration < maxIteration) {
+		// full fitness for final iterations
+		if (iteration == coarseIteration && coarse) {
+			return beginRefine(PHASE_REFINE);
+		}
+
+		if (getDispersionIDX() < convergenceThreshold && getVelocityIDX() < convergenceThreshold) {
+			stopReason = STOP_CONVERGENCE;
+			return finish();
+		}
+
+		// coarse fitness is refined at coarseIteration or when finished, keep budget of refine pass
+		if ( isStopped(coarse ? 2*particleNum : particleNum, gBestFitness, !coarse) ) {
+			return finish();
+		}
+
+		moveParticles();
+		phase = PHASE_MOVE;
+		return prepareEvaluation(true);
+	}
+
+	return finish();
+}
+
+int PsoSolver::finish() {
+	// converged before full fitness iterations
+	if (coarse) {
+		return beginRefine(PHASE_FINAL);
+	}
+
+	phase = PHASE_DONE;
+	return 0;
+}
+
+void PsoSolver::run(const bool enableGLNPSO, const double minIw) {
+	int pending = begin(enableGLNPSO, minIw);
+	while (pending > 0) {
+		evaluatePending();
+		pending = advance();
+	}
 }
\ No newline at end of file
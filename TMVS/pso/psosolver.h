@@ -8,7 +8,8 @@
 // include openMP
 #include <omp.h>
 
-#include "particle.h"
+#include "optimizer.h"
+#include "random.h"
 
 using namespace std;
 using namespace PAIS;
@@ -18,32 +19,49 @@ namespace PAIS {
 	struct LocalParticle {
 		// distance from pbest to current position 
 		double dist; 
-		// pbest holder
-		const Particle *p;
+		// pbest holder index
+		int idx;
 	};
 
-	class PsoSolver {
+	class PsoSolver : public Optimizer {
 	private:
+		// run phase of pending evaluation
+		static const int PHASE_INIT   = 0x00;
+		static const int PHASE_MOVE   = 0x01;
+		static const int PHASE_REFINE = 0x02;
+		static const int PHASE_FINAL  = 0x03;
+		static const int PHASE_DONE   = 0x04;
+
 		// sorter for using Local Best
         static bool sortLocalParticle (const LocalParticle &i, const LocalParticle &j);
 
-		// dimension of problem space
-		int dim;
-
-		// number of iteration
-        int iteration;
-
-		// max number of iteration
-        int maxIteration;
-
 		// number of particle
 		int particleNum;
 
 		// DispersionIDX and VelocityIDX convergence threshold
         double convergenceThreshold;
 
-		// particle container
-		vector<Particle> particles;
+		// swarm arena, one allocation for all particles (pos, vec, pBest, nBest of particleNum*dim)
+		vector<double> swarm;
+		// particle-major arrays in swarm arena (particle i at [i*dim])
+		double *pos;
+		double *vec;
+		double *pBest;
+		double *nBest;
+		// particle fitness arrays (particleNum)
+		vector<double> fitness;
+		vector<double> pBestFitness;
+		vector<int>    fitnessBounded;
+		// local best of particles (GLN-PSO)
+		vector<const double*> lBest;
+		// pairwise squared pBest distance, updated once per iteration (particleNum*particleNum, GLN-PSO)
+		vector<double> pBestDist;
+		// particle index sorted by pBest fitness (particleNum)
+		mutable vector<LocalParticle> bestParticles;
+		// neighbor selection buffer of each particle (particleNum*particleNum, GLN-PSO)
+		vector<LocalParticle> localParticles;
+		// maximum fitness distance ratio of nBest in each dimension (particleNum*dim, GLN-PSO)
+		vector<double> nBestFDR;
 
 		// upper and lower range
         double *rangeL;
@@ -57,6 +75,7 @@ namespace PAIS {
 
 		// velocity weight
         double iw; // inertia weight  (Basic-PSO)
+        double initIw; // inertia weight before linear adjustment
         double pw; // pBest weight    (Basic-PSO)
         double gw; // gBest weight    (Basic-PSO)
 		double lw; // lBest weight    (GLN-PSO)
@@ -64,19 +83,43 @@ namespace PAIS {
 	
 		// local best K nearest neighbor (GLN-PSO)
 		int localK;
+		int initLocalK; // requested K before clamping to particle number
 
 		// flag for using GLN-PSO
 		bool enableGLNPSO;
-
-		// fitness function
-        double (*getFitness)(const Particle &p, void *obj);
-		// bundled object for fitness function
-		void *obj;
+		// lower bound of linear inertia weight adjustment
+		double minIw;
+		// run phase waiting for evaluation of pending particles
+		int phase;
+
+		// batched fitness buffers
+		vector<double> batchPos;
+		vector<double> batchBound;
+
+		// flag for bounding fitness evaluation by pBest fitness
+		bool enableFitnessBound;
+
+		// initial particle position sampling and random shift of quasi-random sequence (dim)
+		int initialization;
+		vector<double> initShift;
+
+		// switch fitness function between coarse and full evaluation
+		void (*setFitnessCoarse)(const bool coarse, void *obj);
+		// iterations evaluated by coarse fitness
+		int coarseIteration;
+		// current fitness is coarse
+		bool coarse;
+
+		// random stream of each particle (moved in parallel without sharing state)
+		vector<Random> rng;
+		// seed of particle streams, reseed on next swarm initialization
+		unsigned long long seed;
+		bool reseed;
 
 		// set random seed to current time and thread
-		void setRandomSeed() const;
-		// return uniform random number [0, 1]
-        inline double random();
+		void setRandomSeed();
+		// return uniform random number [0, 1) of particle idx stream
+        inline double random(const int idx);
 
 		// PSO convergence index
 		double getDispersionIDX() const;
@@ -85,19 +128,40 @@ namespace PAIS {
 		// set initial particle position and velocity
 		void initParticles();
 
-		// set initial particle fitness
+		// count evaluation of all particles and gather batch positions and bounds (pBest fitness if bounded), return particle number
+		int prepareEvaluation(const bool bounded);
+
+		// evaluate all pending particles
+		void evaluatePending();
+
+		// set initial particle fitness and gBest
 		void initFitness();
 
-		// update particle fitness
+		// update particle pBest
 		void updateFitness();
 
 		// move particle
 		void moveParticles();
 
+		// switch to full fitness and evaluate pBest positions, return pending particle number
+		int beginRefine(const int phase);
+
+		// re-evaluated pBest and gBest by full fitness
+		void refineFitness();
+
+		// check stopping rules, then move particles or finish run, return pending particle number
+		int nextIteration();
+
+		// refine coarse fitness once more or end run, return pending particle number
+		int finish();
+
 		// update gbest
 		void updateGbest();
 
-		const double* getLocalBest(const int idx) const;
+		// update pBest distance, lBest and nBest of all particles (GLN-PSO)
+		void setNeighborhood();
+
+		void setLocalBest(const int idx);
 
 		void setNearNeighborBest(const int idx);
 	public:
@@ -112,12 +176,39 @@ namespace PAIS {
 
         ~PsoSolver(void);
 
+		// get solver reused by current OpenMP thread (reset() before each run)
+		static PsoSolver& getThreadSolver(const int dim);
+
+		// reuse solver for a new problem without reallocation, init is the initial guess of first particle (NULL for none)
+		void reset(const double *rangeL, const double *rangeU, const double *init, const int maxIteration, const int particleNum);
+		// set random seed of particle streams for reproducible runs, applied on next reset()
+		void setRandomSeed(const unsigned long long seed);
+		// view of particle idx for fitness function
+		Particle getParticle(const int idx) const;
 		bool setParticle(const double *pos, const double *vec = NULL, const int idx = 0);
+		// stop batched fitness evaluation early once it cannot beat pBest
+		void setFitnessBound(const bool enable) { enableFitnessBound = enable; }
+		// best num pBest positions (num*dim, best first) and mean absolute velocity (dim), return position number
+		int getSwarmSummary(const int num, double *pos, double *spread) const;
+		// warm start particles 1~num at pos (clamped into range) with velocity uniform in -spread~spread, after reset()
+		void setSwarmSummary(const double *pos, const int num, const double *spread);
+		// initial particle position sampling, applied on next reset()
+		void setInitialization(const int initialization);
+		// evaluate first coarseIteration iterations by coarse fitness, final gBest is always full fitness
+		void setCoarseFitness(void (*setFitnessCoarse)(const bool coarse, void *obj), const int coarseIteration);
 		void run(const bool enableGLNPSO = false, const double minIw = 0.4);
+		// stepped run for evaluating many solvers in lockstep: begin(), then evaluatePending() of every pending particle
+		// and advance() until no particle is pending (run() is the same loop for one solver)
+		// start run, return pending particle number
+		int begin(const bool enableGLNPSO = true, const double minIw = 0.4);
+		// evaluate pending particle idx, particles and solvers may be evaluated concurrently
+		void evaluatePending(const int idx);
+		// use evaluated fitness and step run to next evaluation, return pending particle number (0 when finished)
+		int advance();
+		// run GLN-PSO (optimizer contract)
+		void optimize() { run(true); }
 
-		int           getDimension()      const { return dim; }
 		int           getParticleNum()    const { return particleNum; }
-        int           getMaxIteration()   const { return maxIteration; }
         double        getInertiaWeight()  const { return iw; }
         double        getPbestWeight()    const { return pw; }
         double        getGbestWeight()    const { return gw; }
@@ -128,7 +219,6 @@ namespace PAIS {
         const double* getRangeU()         const { return rangeU; }
 		double        getGbestFitness()   const { return gBestFitness; }
         int           getGbestIteration() const { return gBestIteration; }
-		int           getIteration()      const { return iteration; }
 	};
 };
 
@@ -0,0 +1,22 @@
+#include "random.h"
+
+using namespace PAIS;
+
+Random::Random(const unsigned long long seed) {
+	setSeed(seed);
+}
+
+Random::~Random(void) {
+}
+
+void Random::setSeed(const unsigned long long seed, const unsigned long long stream) {
+	// splitmix64 expansion, streams are spaced by the golden ratio increment
+	unsigned long long x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+	for (int i = 0; i < 4; i++) {
+		x += 0x9E3779B97F4A7C15ULL;
+		unsigned long long z = x;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		state[i] = z ^ (z >> 31);
+	}
+}
\ No newline at end of file
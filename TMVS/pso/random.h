@@ -0,0 +1,44 @@
+#ifndef __PAIS_RANDOM_H__
+#define __PAIS_RANDOM_H__
+
+namespace PAIS {
+	// xoshiro256** pseudo random generator, one independent stream per owner
+	class Random {
+	private:
+		// generator state
+		unsigned long long state[4];
+
+		static inline unsigned long long rotl(const unsigned long long x, const int k) {
+			return (x << k) | (x >> (64 - k));
+		}
+
+	public:
+		Random(const unsigned long long seed = 0);
+		~Random(void);
+
+		// seed state by splitmix64 of seed and stream index
+		void setSeed(const unsigned long long seed, const unsigned long long stream = 0);
+
+		// next 64-bit random number
+		inline unsigned long long next() {
+			const unsigned long long result = rotl(state[1] * 5, 7) * 9;
+			const unsigned long long t = state[1] << 17;
+
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3]  = rotl(state[3], 45);
+
+			return result;
+		}
+
+		// uniform random number [0, 1)
+		inline double uniform() {
+			return (double) (next() >> 11) * (1.0 / 9007199254740992.0);
+		}
+	};
+};
+
+#endif
\ No newline at end of file
@@ -216,16 +216,16 @@ void MvsViewer::addPatch(const Patch &pth) {
 }
 
 void MvsViewer::addPatches() {
-	const map<int, Patch> &patches = mvs->getPatches();
-	map<int, Patch>::const_iterator it;
+	const SlotMap<Patch> &patches = mvs->getPatches();
 
-	for (it = patches.begin(); it != patches.end(); ++it) {
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
 		// patch center
-		const Vec3d &p = it->second.getCenter();
+		const Vec3d &p = patches.at(s).getCenter();
 		// patch normal
-		const Vec3d &n = it->second.getNormal();
+		const Vec3d &n = patches.at(s).getNormal();
 		// patch color
-		const Vec3b &c = it->second.getColor();
+		const Vec3b &c = patches.at(s).getColor();
 		
 		PointXYZRGB pt;
 		pt.x = p[0];
@@ -256,11 +256,10 @@ void MvsViewer::addPatches() {
 }
 
 void MvsViewer::addPatchesAnimate() {
-	const map<int, Patch> &patches = mvs->getPatches();
-	const int pthNum = (int) mvs->getPatches().size();
-	map<int, Patch>::const_iterator it;
-	for (it = patches.begin(); it != patches.end(); ++it) {
-		addPatch(it->second);
+	const SlotMap<Patch> &patches = mvs->getPatches();
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		addPatch(patches.at(s));
 	}
 }
 
@@ -357,15 +356,19 @@ void MvsViewer::reduceNormalLevel() {
 
 const Patch* MvsViewer::getPickedPatch(const int idx) const {
 	// skip out of index boundary
-	if (idx > mvs->getPatches().size() || idx < 0) {
+	if (idx >= mvs->getPatches().size() || idx < 0) {
 		return NULL;
 	}
 
-	map<int, Patch>::const_iterator it;
-	it = mvs->getPatches().begin();
-	for (int i = 0; i < idx; ++it, ++i);
+	// idx-th patch in slot order (point cloud order)
+	const SlotMap<Patch> &patches = mvs->getPatches();
+	int i = 0;
+	for (int s = 0; s < patches.getSlotNum(); ++s) {
+		if ( !patches.isUsed(s) ) continue;
+		if (i++ == idx) return &patches.at(s);
+	}
 
-	return &it->second;
+	return NULL;
 }
 
 void MvsViewer::showPickedPoint(const Patch &pth) {